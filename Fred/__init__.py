@@ -7,7 +7,7 @@ The above copyright notice and this permission notice shall be included in all c
 
 THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 """
-from .backend import Curve, Curves, continuous_frechet, discrete_dynamic_time_warping, discrete_frechet, discrete_klcenter, discrete_klmedian, dimension_reduction, dtw_approximate_minimum_error_simplification, frechet_approximate_minimum_error_simplification, frechet_approximate_minimum_link_simplification, frechet_minimum_error_simplification
+from .backend import Options, Curve, Curves, distances, pairwise_distances, frechet_less_than, continuous_frechet, discrete_dynamic_time_warping, discrete_frechet, discrete_klcenter, discrete_klmedian, dimension_reduction, dtw_approximate_minimum_error_simplification, frechet_approximate_minimum_error_simplification, frechet_approximate_minimum_link_simplification, frechet_minimum_error_simplification
 from .stabbing import stabbing_path as _stabbing_path
 
 import psutil
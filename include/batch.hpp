@@ -0,0 +1,55 @@
+/*
+Copyright 2020-2021 Dennis Rohde
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <functional>
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+
+#include "config.hpp"
+#include "types.hpp"
+#include "curve.hpp"
+#include "frechet.hpp"
+#include "dynamic_time_warping.hpp"
+#include "simplification.hpp"
+
+namespace py = pybind11;
+
+/*
+ * Distances between many pairs of curves at once. Pairs are distributed dynamically over all threads and the GIL is released meanwhile.
+ * distance_func selects the distance as in the clustering: 0 continuous Fréchet, 1 discrete Fréchet, 2 discrete dynamic time warping.
+ * less_than_or_equal decides for every curve whether its continuous, or discrete, Fréchet distance to the query is at most the given distance.
+ * simplify computes the (approximate) minimum error simplification of every curve under the continuous Fréchet distance; curves are handed out
+ * one at a time, longest first. progress is called as progress(done, total) by whichever thread finished a curve, one call at a time with growing
+ * done, and at the end; when it raises, the remaining curves are skipped and the exception is passed on.
+ */
+namespace Batch {
+    
+    distance_t distance(const Curve&, const Curve&, const unsigned int, const Config::Options& = Config::Options());
+    
+    py::array_t<distance_t> distances(const Curve&, const Curves&, const unsigned int = 0, const Config::Options& = Config::Options());
+    py::array_t<distance_t> pairwise_distances(const Curves&, const Curves&, const unsigned int = 0, const Config::Options& = Config::Options());
+    py::array_t<distance_t> pairwise_distances(const Curves&, const unsigned int = 0, const Config::Options& = Config::Options());
+    
+    py::array_t<bool> less_than_or_equal(const Curve&, const Curves&, const distance_t, const bool = false, const Config::Options& = Config::Options());
+    
+    Curve simplification(const Curve&, const curve_size_t, const bool = false, const Config::Options& = Config::Options());
+    Curves simplify(const Curves&, const curve_size_t, const bool = false, const py::object& = py::none(), const Config::Options& = Config::Options());
+    
+    void _distances(const Curve&, const Curves&, distance_t*, const unsigned int, const Config::Options&);
+    void _pairwise_distances(const Curves&, const Curves&, distance_t*, const unsigned int, const Config::Options&);
+    void _pairwise_distances(const Curves&, distance_t*, const unsigned int, const Config::Options&);
+    void _less_than_or_equal(const Curve&, const Curves&, const distance_t, bool*, const bool, const Config::Options&);
+    // progress gets the number of curves done and returns whether to go on
+    void _simplify(const Curves&, Curves&, const curve_size_t, const bool, const Config::Options&, const std::function<bool(const curve_number_t)>& = nullptr);
+    
+}
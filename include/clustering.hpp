@@ -33,9 +33,9 @@ namespace Clustering {
 
 struct Distance_Matrix;
 struct Cluster_Assignment;
+struct Cache;
 
-extern Distance_Matrix distances;
-extern Curves simplifications;
+using Envelopes = std::vector<Dynamic_Time_Warping::Discrete::Envelope>;
 
 struct Distance_Matrix : public std::vector<Distances> {
     Distance_Matrix() = default;
@@ -48,12 +48,22 @@ struct Distance_Matrix : public std::vector<Distances> {
     void print() const;
 };
 
+/*
+ * Distances of the input curves to the simplifications and the simplifications computed so far, of one clustering,
+ * and the fingerprint of its input curves, which a consecutive call or assignment must match.
+ */
+struct Cache {
+    std::size_t input = 0;
+    Distance_Matrix distances;
+    Curves simplifications;
+};
+
 struct Clustering_Result {
     Curves centers;
     distance_t value;
     double running_time;
     
-    explicit Clustering_Result(const unsigned int distance_func = 0) : distance_func{distance_func} {}
+    explicit Clustering_Result(const unsigned int distance_func = 0, const Config::Options &options = Config::Options()) : distance_func{distance_func}, options{options} {}
     const Curve& get(const curve_number_t) const;
     Cluster_Assignment& get_assignment() const;
     void set(const curve_number_t, const Curve&);
@@ -62,13 +72,23 @@ struct Clustering_Result {
     Curves::const_iterator cend() const;
     void compute_assignment(const Curves&, const bool = false);
     void set_center_indices(const Curve_Numbers&);
+    void set_cache(const std::shared_ptr<Cache>&);
     py::list compute_center_enclosing_balls(const Curves&, const bool);
     const unsigned int get_distance_func() const;
+    const Config::Options& get_options() const;
+    const PDistance* assignment_distance(const curve_number_t, const curve_number_t) const;
     
 private:
     Curve_Numbers center_indices;
     unsigned int distance_func;
+    Config::Options options;
     std::unique_ptr<Cluster_Assignment> assignment;
+    // the clustering's cache, which a consecutive assignment uses, and the distances to the centers of any other assignment
+    std::shared_ptr<Cache> cache;
+    Distance_Matrix assignment_distances;
+    bool consecutive_assignment = false;
+    
+    const Distance_Matrix& get_assignment_distances() const;
 };
 
 struct Cluster_Assignment : public std::vector<Curve_Numbers> {
@@ -85,18 +105,48 @@ private:
     const unsigned int distance_func;
 };
 
-inline distance_t _cheap_dist(const curve_number_t i, const curve_number_t j, const Curves &in, const Curves &simplified_in, Distance_Matrix &distances, const unsigned int distance_func) {
-    if (Config::use_distance_matrix) {
+/*
+ * Lower bound cascade for the dynamic time warping distance, LB_Kim and then LB_Keogh; when envelopes is given, it caches the envelopes
+ * of simplified_in for this clustering, as long as the curves they are compared to have the same complexity.
+ */
+inline bool _dtw_exceeds(const Curve &curve, const curve_number_t j, const Curves &simplified_in, Envelopes *envelopes, const distance_t cutoff, const Config::Options &options) {
+    if (not (cutoff < std::numeric_limits<distance_t>::infinity())) return false;
+    if (Dynamic_Time_Warping::Discrete::lower_bound_kim(curve, simplified_in[j]) > cutoff) return true;
+    if (envelopes) {
+        if (envelopes->size() != simplified_in.size()) envelopes->resize(simplified_in.size());
+        auto &envelope = (*envelopes)[j];
+        if (not envelope.fits(curve.complexity(), options)) envelope = Dynamic_Time_Warping::Discrete::envelope(simplified_in[j], curve.complexity(), options);
+        return Dynamic_Time_Warping::Discrete::lower_bound_keogh(curve, envelope, cutoff) > cutoff;
+    }
+    return Dynamic_Time_Warping::Discrete::lower_bound_keogh(curve, Dynamic_Time_Warping::Discrete::envelope(simplified_in[j], curve.complexity(), options), cutoff) > cutoff;
+}
+
+/*
+ * Distances of the discrete Fréchet and the dynamic time warping distance are abandoned once they exceed cutoff, which gives infinity.
+ * Such distances are not stored in the distance matrix, as they are only valid for this cutoff. The dynamic time warping distance
+ * is not computed at all when its lower bounds exceed cutoff.
+ */
+inline distance_t _cheap_dist(const curve_number_t i, const curve_number_t j, const Curves &in, const Curves &simplified_in, Distance_Matrix &distances, Envelopes *envelopes, const unsigned int distance_func, const Config::Options &options, const distance_t cutoff = std::numeric_limits<distance_t>::infinity()) {
+    if (options.use_distance_matrix) {
         if (not *distances[i][j]) {
             switch (distance_func) {
                 case 0:
-                    distances[i][j] = std::make_unique<const Frechet::Continuous::Distance>(Frechet::Continuous::distance(in[i], simplified_in[j]));
+                    distances[i][j] = std::make_unique<const Frechet::Continuous::Distance>(Frechet::Continuous::distance(in[i], simplified_in[j], false, Frechet::Continuous::Budget(), options));
                     break;
                 case 1:
-                    distances[i][j] = std::make_unique<const Frechet::Discrete::Distance>(Frechet::Discrete::distance(in[i], simplified_in[j]));
+                    {
+                        auto dist = Frechet::Discrete::distance(in[i], simplified_in[j], cutoff);
+                        if (dist.value > cutoff) return dist.value;
+                        distances[i][j] = std::make_unique<const Frechet::Discrete::Distance>(dist);
+                    }
                     break;
                 case 2:
-                    distances[i][j] = std::make_unique<const Dynamic_Time_Warping::Discrete::Distance>(Dynamic_Time_Warping::Discrete::distance(in[i], simplified_in[j]));
+                    {
+                        if (_dtw_exceeds(in[i], j, simplified_in, envelopes, cutoff, options)) return std::numeric_limits<distance_t>::infinity();
+                        auto dist = Dynamic_Time_Warping::Discrete::distance(in[i], simplified_in[j], cutoff, options);
+                        if (dist.value > cutoff) return dist.value;
+                        distances[i][j] = std::make_unique<const Dynamic_Time_Warping::Discrete::Distance>(std::move(dist));
+                    }
                     break;
             }
         }
@@ -104,26 +154,27 @@ inline distance_t _cheap_dist(const curve_number_t i, const curve_number_t j, co
     } else {
         switch (distance_func) {
                 case 0:
-                    return Frechet::Continuous::distance(in[i], simplified_in[j]).value;
+                    return Frechet::Continuous::distance(in[i], simplified_in[j], false, Frechet::Continuous::Budget(), options).value;
                 case 1:
-                    return Frechet::Discrete::distance(in[i], simplified_in[j]).value;
+                    return Frechet::Discrete::distance(in[i], simplified_in[j], cutoff).value;
                 case 2:
-                    return Dynamic_Time_Warping::Discrete::distance(in[i], simplified_in[j]).value;
+                    if (_dtw_exceeds(in[i], j, simplified_in, envelopes, cutoff, options)) return std::numeric_limits<distance_t>::infinity();
+                    return Dynamic_Time_Warping::Discrete::distance(in[i], simplified_in[j], cutoff, options, false).value;
                 default:
                     return std::numeric_limits<distance_t>::signaling_NaN();
         }
     }
 }
 
-inline curve_number_t _nearest_center(const curve_number_t i, const Curves &in, const Curves &simplified_in, const Curve_Numbers &centers, Distance_Matrix &distances, const unsigned int distance_func) {
+inline curve_number_t _nearest_center(const curve_number_t i, const Curves &in, const Curves &simplified_in, const Curve_Numbers &centers, Distance_Matrix &distances, Envelopes *envelopes, const unsigned int distance_func, const Config::Options &options) {
     const distance_t infty = std::numeric_limits<distance_t>::infinity();
     // cost for curve is infinity
     distance_t min_cost = infty, curr_cost;
     curve_number_t nearest = 0;
     
-    // except there is a center with smaller cost, then choose the one with smallest cost
+    // except there is a center with smaller cost, then choose the one with smallest cost; no other center needs to be computed beyond that cost
     for (curve_number_t j = 0; j < centers.size(); ++j) {
-        curr_cost = _cheap_dist(i, centers[j], in, simplified_in, distances, distance_func);
+        curr_cost = _cheap_dist(i, centers[j], in, simplified_in, distances, envelopes, distance_func, options, min_cost);
         if (curr_cost < min_cost) {
             min_cost = curr_cost;
             nearest = j;
@@ -132,36 +183,36 @@ inline curve_number_t _nearest_center(const curve_number_t i, const Curves &in,
     return nearest;
 }
 
-inline distance_t _curve_cost(const curve_number_t i, const Curves &in, const Curves &simplified_in, const Curve_Numbers &centers, Distance_Matrix &distances, const unsigned int distance_func) {
-    return _cheap_dist(i, centers[_nearest_center(i, in, simplified_in, centers, distances, distance_func)], in, simplified_in, distances, distance_func);
+inline distance_t _curve_cost(const curve_number_t i, const Curves &in, const Curves &simplified_in, const Curve_Numbers &centers, Distance_Matrix &distances, Envelopes *envelopes, const unsigned int distance_func, const Config::Options &options) {
+    return _cheap_dist(i, centers[_nearest_center(i, in, simplified_in, centers, distances, envelopes, distance_func, options)], in, simplified_in, distances, envelopes, distance_func, options);
 }
 
-inline distance_t _center_cost_sum(const Curves &in, const Curves &simplified_in, const Curve_Numbers &centers, Distance_Matrix &distances, const unsigned int distance_func) {
+inline distance_t _center_cost_sum(const Curves &in, const Curves &simplified_in, const Curve_Numbers &centers, Distance_Matrix &distances, Envelopes *envelopes, const unsigned int distance_func, const Config::Options &options) {
     distance_t cost = 0;
     
     // for all curves
     for (curve_number_t i = 0; i < in.size(); ++i) {
-        const distance_t min_cost_elem = _curve_cost(i, in, simplified_in, centers, distances, distance_func);
+        const distance_t min_cost_elem = _curve_cost(i, in, simplified_in, centers, distances, envelopes, distance_func, options);
         cost += min_cost_elem;
     }
     return cost;
 }
 
-inline distance_t _center_cost_max(const Curves &in, const Curves &simplified_in, const Curve_Numbers &centers, Distance_Matrix &distances, const unsigned int distance_func) {
+inline distance_t _center_cost_max(const Curves &in, const Curves &simplified_in, const Curve_Numbers &centers, Distance_Matrix &distances, Envelopes *envelopes, const unsigned int distance_func, const Config::Options &options) {
     distance_t cost = 0;
     
     // for all curves
     for (curve_number_t i = 0; i < in.size(); ++i) {
-        const auto min_cost_elem = _curve_cost(i, in, simplified_in, centers, distances, distance_func);
+        const auto min_cost_elem = _curve_cost(i, in, simplified_in, centers, distances, envelopes, distance_func, options);
         cost = std::max(cost, min_cost_elem);
     }
     return cost;
 }
 
-Clustering_Result kl_cluster(const curve_number_t, const curve_size_t, const Curves &, unsigned int, const bool, const bool, const bool, const bool, const unsigned int distance_func);
+Clustering_Result kl_cluster(const curve_number_t, const curve_size_t, const Curves &, unsigned int, const bool, const bool, const bool, const bool, const unsigned int distance_func, Config::Options);
 
-Clustering_Result kl_center(const curve_number_t, const curve_size_t, const Curves &, unsigned int, const bool = false, const bool = true, const bool = false, const unsigned int distance_func = 0);
+Clustering_Result kl_center(const curve_number_t, const curve_size_t, const Curves &, unsigned int, const bool = false, const bool = true, const bool = false, const unsigned int distance_func = 0, const Config::Options& = Config::Options());
 
-Clustering_Result kl_median(const curve_number_t, const curve_size_t, const Curves &, const bool = false, const bool = false, const unsigned int distance_func = 0); 
+Clustering_Result kl_median(const curve_number_t, const curve_size_t, const Curves &, const bool = false, const bool = false, const unsigned int distance_func = 0, const Config::Options& = Config::Options()); 
 
 }
@@ -12,6 +12,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <cstddef>
 
+#include "types.hpp"
+
 namespace Config {
     
     struct Config{};
@@ -22,5 +24,26 @@ namespace Config {
     extern int number_threads;
     extern bool use_distance_matrix;
     extern bool dtw_contingency;
+    extern long dtw_sakoe_chiba_radius;
+    extern distance_t dtw_itakura_slope;
+    extern long dtw_approximation_radius;
+    extern distance_t continuous_frechet_error;
+    extern bool continuous_frechet_compact;
+    
+    /*
+     * Settings of a single call, passed down through distances, simplifications and clusterings.
+     * The globals above are only their defaults, read when the options are constructed, so calls with different options can run concurrently.
+     */
+    struct Options {
+        std::size_t available_memory = ::Config::available_memory;
+        unsigned int verbosity = ::Config::verbosity;
+        bool use_distance_matrix = ::Config::use_distance_matrix;
+        bool dtw_contingency = ::Config::dtw_contingency;
+        long dtw_sakoe_chiba_radius = ::Config::dtw_sakoe_chiba_radius;
+        distance_t dtw_itakura_slope = ::Config::dtw_itakura_slope;
+        long dtw_approximation_radius = ::Config::dtw_approximation_radius;
+        distance_t continuous_frechet_error = ::Config::continuous_frechet_error;
+        bool continuous_frechet_compact = ::Config::continuous_frechet_compact;
+    };
     
 }
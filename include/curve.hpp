@@ -17,66 +17,71 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <pybind11/pybind11.h>
 #include <pybind11/numpy.h>
 
+#include "config.hpp"
 #include "types.hpp"
 #include "point.hpp"
 #include "interval.hpp"
 
 namespace py = pybind11;
 
+/*
+ * A curve shares its storage with its copies and subcurves until it is modified,
+ * hence copies and subcurves are cheap and safe to read from concurrently.
+ */
 class Curve : private Points {
     
-    curve_size_t vstart = 0, vend = 0;
     std::string name;
     
 public:
     typedef typename Points::iterator iterator;
+    typedef typename Points::const_iterator const_iterator;
     
-    inline Curve(const dimensions_t dim, const std::string &name = "unnamed curve") : Points(dim), vstart{0}, vend{0}, name{name} {}
-    inline Curve(const curve_size_t m, const dimensions_t dimensions, const std::string &name = "unnamed curve") : Points(m, Point(dimensions)), vstart{0}, vend{m-1}, name{name} {}
+    inline Curve(const dimensions_t dim, const std::string &name = "unnamed curve") : Points(dim), name{name} {}
+    inline Curve(const curve_size_t m, const dimensions_t dimensions, const std::string &name = "unnamed curve") : Points(m, dimensions), name{name} {}
     Curve(const Points &points, const std::string &name = "unnamed curve");
-    Curve(const py::array_t<coordinate_t> &in, const std::string &name = "unnamed curve");
+    Curve(const py::array_t<coordinate_t> &in, const std::string &name = "unnamed curve", const bool copy = true);
     
-    inline Point& get(const curve_size_t i) {
-        return Points::operator[](vstart + i);
+    inline Point get(const curve_size_t i) const {
+        return Points::operator[](i);
     }
     
-    inline const Point& operator[](const curve_size_t i) const {
-        return Points::operator[](vstart + i);
+    inline Const_Point_View operator[](const curve_size_t i) const {
+        return Points::operator[](i);
     }
     
-    inline Point& operator[](const curve_size_t i) {
-        return Points::operator[](vstart + i);
+    inline Point_View operator[](const curve_size_t i) {
+        return Points::operator[](i);
     }
     
-    inline const Point& front() const {
-        return Points::operator[](vstart);
+    inline Const_Point_View front() const {
+        return Points::operator[](0);
     }
     
-    inline Point& front() {
-        return Points::operator[](vstart);
+    inline Point_View front() {
+        return Points::operator[](0);
     }
     
-    inline const Point& back() const {
-        return Points::operator[](vend);
+    inline Const_Point_View back() const {
+        return Points::operator[](complexity() - 1);
     }
     
-    inline Point& back() {
-        return Points::operator[](vend);
+    inline Point_View back() {
+        return Points::operator[](complexity() - 1);
     }
     
-    inline const auto begin() const {
+    inline const_iterator begin() const {
         return Points::begin();
     }
     
-    inline const auto end() const {
+    inline const_iterator end() const {
         return Points::end();
     }
     
-    inline auto begin() {
+    inline iterator begin() {
         return Points::begin();
     }
     
-    inline auto end() {
+    inline iterator end() {
         return Points::end();
     }
     
@@ -85,47 +90,40 @@ public:
     }
     
     inline curve_size_t complexity() const {
-        return empty() ? 0 : vend - vstart + 1; 
+        return Points::size(); 
     }
     
     inline curve_size_t size() const {
-        return empty() ? 0 : vend - vstart + 1;
+        return Points::size();
     }
     
     inline dimensions_t dimensions() const { 
         return empty() ? 0 : Points::dimensions();
     }
     
-    inline void set_subcurve(const curve_size_t start, const curve_size_t end) {
-        vstart = start;
-        vend = end;
+    // vertices start, ..., end without copying them
+    inline Curve subcurve(const curve_size_t start, const curve_size_t end) const {
+        return Curve(Points(*this, start, end - start + 1), name);
     }
     
-    inline void reset_subcurve() {
-        vstart = 0;
-        vend = Points::size() - 1;
+    inline void push_back(const Const_Point_View &point) {
+        Points::push_back(point);
     }
     
-    inline void push_back(const Point &point) {
-        Points::push_back(point);
-        vend = Points::size() - 1;
+    inline Point centroid() const {
+        return Points::centroid();
     }
     
-    inline void push_back(Point &&point) {
-        Points::push_back(point);
-        vend = Points::size() - 1;
+    inline const coordinate_t* data() const {
+        return Points::data();
     }
     
-    inline Point centroid() const {
-        return Points::centroid();
+    inline coordinate_t* data() {
+        return Points::data();
     }
     
-    inline auto as_ndarray() const {
-        py::list l;
-        for (const Point &elem : *this) {
-            l.append(elem.as_ndarray());
-        }
-        return py::array_t<coordinate_t>(l);
+    inline py::array_t<coordinate_t> as_ndarray() const {
+        return Points::as_ndarray_view(0, complexity());
     }
     
     void set_name(const std::string&);
@@ -141,9 +139,14 @@ class Curves : public std::vector<Curve> {
     curve_size_t m;
     dimensions_t dim;
     
+    void assign_slices(const Points&, const std::vector<curve_size_t>&);
+    
 public:
-    Curves(const dimensions_t dim = 0) : dim{dim} {}
+    Curves(const dimensions_t dim = 0) : m{0}, dim{dim} {}
     Curves(const curve_number_t n, const curve_size_t m, const dimensions_t dim) : std::vector<Curve>(n, Curve(dim)), m{m}, dim{dim} {}
+    Curves(const Points&, const std::vector<curve_size_t>&);
+    Curves(const py::array_t<coordinate_t>&, const bool = true);
+    Curves(const py::array_t<coordinate_t>&, const py::array_t<curve_size_t>&, const bool = true);
     
     inline void add(Curve &curve) {
         if (curve.dimensions() != dim) {
@@ -184,15 +187,9 @@ public:
         return dim;
     }
     
-    inline auto as_ndarray() const {
-        py::list l;
-        for (const Curve &elem : *this) {
-            l.append(elem.as_ndarray());
-        }
-        return py::array_t<coordinate_t>(l);
-    }
+    py::object as_ndarray() const;
     
-    Curves simplify(const curve_size_t, const bool);
+    Curves simplify(const curve_size_t, const bool, const Config::Options& = Config::Options());
     
     std::string str() const;
     
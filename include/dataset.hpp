@@ -0,0 +1,44 @@
+/*
+Copyright 2020-2021 Dennis Rohde
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+#include "types.hpp"
+#include "curve.hpp"
+
+/*
+ * Binary file format for curves, all numbers in native byte order:
+ * 
+ * header:      char[8] magic "FREDCRV", uint64 version, number of curves n, dimensions d, total number of points N, size of names in bytes
+ * offsets:     uint64[n + 1], curve i consists of the points offsets[i], ..., offsets[i + 1] - 1
+ * coordinates: float64[N * d], row-major
+ * names:       optional, n zero-terminated strings
+ * 
+ * Loaded curves are memory-mapped, their coordinates are read from the file on demand and never copied to the heap.
+ */
+namespace Dataset {
+    
+    struct Header {
+        char magic[8];
+        std::uint64_t version;
+        std::uint64_t number_curves;
+        std::uint64_t dimensions;
+        std::uint64_t number_points;
+        std::uint64_t names_size;
+    };
+    
+    void save(const Curves&, const std::string&, const bool = true);
+    
+    Curves load(const std::string&);
+    
+}
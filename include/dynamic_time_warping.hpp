@@ -35,9 +35,38 @@ namespace Discrete {
         curve_size_t n, m;
     };
     
-    Points vertices_matching_points(const Curve&, const Curve&, const Distance&);
+    Points vertices_matching_points(const Curve&, const Curve&, const Distance&, const Config::Options& = Config::Options());
     
-    Distance distance(const Curve&, const Curve&);
+    /*
+     * With a cutoff, the computation is abandoned as soon as the distance is known to exceed it; value is infinity and matching empty then.
+     * Without matching, only the value is computed; without contingency and bands, in memory linear in the smaller complexity.
+     */
+    Distance distance(const Curve&, const Curve&, const distance_t = std::numeric_limits<distance_t>::infinity(), const Config::Options& = Config::Options(), const bool = true);
+    
+    /*
+     * Bounding boxes of the vertices of curve2 that each vertex of a curve1 of the given complexity may be matched to under the band of the options.
+     */
+    struct Envelope {
+        curve_size_t complexity = 0;
+        long sakoe_chiba_radius = -1;
+        distance_t itakura_slope = 0;
+        Points lower, upper;
+        
+        Envelope() : lower(0), upper(0) {}
+        
+        inline bool fits(const curve_size_t complexity1, const Config::Options &options) const {
+            return complexity == complexity1 and sakoe_chiba_radius == options.dtw_sakoe_chiba_radius and itakura_slope == options.dtw_itakura_slope;
+        }
+    };
+    
+    Envelope envelope(const Curve&, const curve_size_t, const Config::Options& = Config::Options());
+    
+    /*
+     * Lower bounds of the distance, LB_Kim: the first and the last vertices are always matched to each other,
+     * LB_Keogh: every vertex of curve1 is matched to a vertex in its box of the envelope of curve2; it stops summing once cutoff is exceeded.
+     */
+    distance_t lower_bound_kim(const Curve&, const Curve&);
+    distance_t lower_bound_keogh(const Curve&, const Envelope&, const distance_t = std::numeric_limits<distance_t>::infinity());
 }
 
 }
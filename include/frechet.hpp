@@ -10,6 +10,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #pragma once
 
+#include <chrono>
+
 #include <pybind11/pybind11.h>
 
 #include "config.hpp"
@@ -21,8 +23,6 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 namespace Frechet {
 namespace Continuous {
     
-    extern distance_t error;
-    
     struct Distance : public PDistance {
         explicit operator bool() const {
             return true;
@@ -30,20 +30,73 @@ namespace Continuous {
         
         std::string repr() const;
         
-        double time_searches;
-        double time_bounds;
-        std::size_t number_searches;
+        double time_searches = 0;
+        double time_bounds = 0;
+        std::size_t number_searches = 0;
+        distance_t lower_bound = std::numeric_limits<distance_t>::quiet_NaN(), upper_bound = std::numeric_limits<distance_t>::quiet_NaN();
+    };
+    
+    /*
+     * Limits the search of distance to a number of seconds, measured from the call on, or a number of decisions; zero means no limit.
+     * When the budget is exhausted, the bracket [lower_bound, upper_bound] reached so far is returned and value is its upper bound.
+     */
+    struct Budget {
+        double seconds = 0;
+        std::size_t searches = 0;
+        
+        inline bool exhausted(const std::chrono::steady_clock::time_point start, const std::size_t number_searches) const {
+            if (searches > 0 and number_searches >= searches) return true;
+            return seconds > 0 and std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= seconds;
+        }
+    };
+    
+    Distance distance(const Curve&, const Curve&, const bool = false, const Budget& = Budget(), const Config::Options& = Config::Options());
+    
+    bool less_than_or_equal(const distance_t, const Curve&, const Curve&, const Config::Options& = Config::Options());
+    
+    /*
+     * Exact distance between a curve and the segment from start to end, which simplifications compare subcurves to.
+     * Every vertex of the curve is matched to a piece of the segment around its projection onto the segment's line, and a matching
+     * exists iff no vertex needs to be matched further along the segment than a later vertex can be. One sweep over the vertices,
+     * which rescans the preceding vertices only when the distance has to be raised.
+     */
+    distance_t segment_distance(const Curve&, const Const_Point_View&, const Const_Point_View&);
+
+    /*
+     * Reachable space of the decision procedure, which is swept row by row, i.e., along the segments of the first curve.
+     * reachable1 holds the reachable parameters on the current segment at the vertices of the second curve, 
+     * reachable2 those at the current vertex on the segments of the second curve, previous_* those of the last row.
+     * The buffers only grow, so one workspace per thread serves all calls without reallocating.
+     * P is the type of the parameters, double in compact mode.
+     */
+    template<class P>
+    struct Basic_Workspace {
+        std::vector<P> reachable1, reachable2, previous_reachable1, previous_reachable2;
+        
+        inline void resize(const curve_size_t n2) {
+            if (n2 > reachable1.size()) {
+                reachable1.resize(n2);
+                reachable2.resize(n2);
+                previous_reachable1.resize(n2);
+                previous_reachable2.resize(n2);
+            }
+        }
+        
+        static inline Basic_Workspace& local() {
+            static thread_local Basic_Workspace workspace;
+            return workspace;
+        }
     };
     
-    Distance distance(const Curve&, const Curve&);
+    typedef Basic_Workspace<parameter_t> Workspace;
+    typedef Basic_Workspace<double> Compact_Workspace;
 
-    Points vertices_matching_points(const Curve&, const Curve&, const Distance&);
+    Points vertices_matching_points(const Curve&, const Curve&, const Distance&, const Config::Options& = Config::Options());
     
-    Distance _distance(const Curve&, const Curve&, distance_t, distance_t);
+    Distance _distance(const Curve&, const Curve&, distance_t, distance_t, const Budget& = Budget(), const std::chrono::steady_clock::time_point = std::chrono::steady_clock::now(), const Config::Options& = Config::Options());
+    Distance _exact_distance(const Curve&, const Curve&, distance_t, distance_t, const Budget& = Budget(), const std::chrono::steady_clock::time_point = std::chrono::steady_clock::now(), const Config::Options& = Config::Options());
             
-    bool _less_than_or_equal(const distance_t, const Curve&, const Curve&, 
-            std::vector<Parameters>&, std::vector<Parameters>&, 
-            std::vector<Intervals>&, std::vector<Intervals>&);
+    bool _less_than_or_equal(const distance_t, const Curve&, const Curve&, const Config::Options& = Config::Options());
             
     distance_t _greedy_upper_bound(const Curve&, const Curve&);
     distance_t _projective_lower_bound(const Curve&, const Curve&);
@@ -58,9 +111,11 @@ namespace Discrete {
         std::string repr() const;
     };
     
-    Distance distance(const Curve&, const Curve&);
+    /*
+     * With a cutoff, the computation is abandoned as soon as the distance is known to exceed it; value is infinity then.
+     */
+    Distance distance(const Curve&, const Curve&, const distance_t = std::numeric_limits<distance_t>::infinity());
     
-    distance_t _dp(std::vector<Distances> &a, const curve_size_t i, const curve_size_t j, 
-            const Curve &curve1, const Curve &curve2);
+    bool less_than_or_equal(const distance_t, const Curve&, const Curve&);
 }
 }
@@ -16,24 +16,28 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include "types.hpp"
 
-class Interval {
-    parameter_t beg, en;
+/*
+ * Interval in [0, 1] with parameters of type T, the empty interval is stored as [1, 0].
+ */
+template<class T>
+class Basic_Interval {
+    T beg, en;
     
 public:
-    Interval() : beg{parameter_t(1)}, en{parameter_t(0)} {}
+    Basic_Interval() : beg{T(1)}, en{T(0)} {}
 
-    Interval(const parameter_t begin, const parameter_t end) : beg{begin}, en{end} {}
+    Basic_Interval(const T begin, const T end) : beg{begin}, en{end} {}
 
-    inline bool operator<(const Interval &other) const {
+    inline bool operator<(const Basic_Interval &other) const {
         return (beg < other.begin()) or ((beg == other.begin()) and (en < other.end()));
     }
 
     inline bool empty() const { 
-        if (en - beg >= std::numeric_limits<parameter_t>::epsilon()) return beg > en;
+        if (en - beg >= std::numeric_limits<T>::epsilon()) return beg > en;
         else return true;
     }
     
-    inline bool intersects(const Interval &other) const {
+    inline bool intersects(const Basic_Interval &other) const {
         if (empty() or other.empty()) return false;
 
         return ((other.beg >= beg) and (other.beg <= en)) or
@@ -41,17 +45,17 @@ public:
             ((other.beg <= beg) and (other.en >= en));
     }
     
-    inline parameter_t begin() const {
+    inline T begin() const {
          return beg; 
     }
     
-    inline parameter_t end() const { 
+    inline T end() const { 
         return en; 
     }
     
     inline void reset() {
-        beg = parameter_t(1);
-        en = parameter_t(0);
+        beg = T(1);
+        en = T(0);
     }
 };
 
@@ -15,7 +15,12 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <cmath>
 #include <string>
 #include <sstream>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
 #include <type_traits>
+#include <memory>
 
 #include <pybind11/pybind11.h>
 #include <pybind11/numpy.h>
@@ -25,9 +30,162 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 namespace py = pybind11;
 
-class Point : public Coordinates {
+class Const_Point_View;
+
+/*
+ * Arithmetic shared by owning points and views into flat coordinate buffers.
+ * T has to provide data() and dimensions().
+ * The distance kernels take the number of dimensions D as template parameter, for D > 0 the loops have
+ * a fixed trip count and are unrolled by the compiler, D = 0 means the number of dimensions is only known at runtime.
+ */
+template<class T>
+class Point_Base {
+    
+    inline const coordinate_t* coords() const {
+        return static_cast<const T&>(*this).data();
+    }
+    
+    inline dimensions_t dims() const {
+        return static_cast<const T&>(*this).dimensions();
+    }
+    
+public:
+    inline Point operator+(const Const_Point_View&) const;
+    
+    inline Point operator-(const Const_Point_View&) const;
+    
+    inline Point operator*(const coordinate_t) const;
+    
+    inline distance_t operator*(const Const_Point_View&) const;
+    
+    inline Point operator/(const coordinate_t) const;
+    
+    template<dimensions_t D = 0>
+    inline distance_t dist_sqr(const Const_Point_View&) const;
+    
+    template<dimensions_t D = 0>
+    inline distance_t dist(const Const_Point_View &point) const {
+        return std::sqrt(dist_sqr<D>(point));
+    }
+    
+    inline distance_t length_sqr() const;
+    
+    inline distance_t length() const {
+        return std::sqrt(length_sqr());
+    }
+    
+    inline Point line_segment_point(const Const_Point_View&, const parameter_t) const;
+    
+    template<dimensions_t D = 0>
+    inline distance_t line_segment_dist_sqr(const Const_Point_View&, const Const_Point_View&) const;
+    
+    template<dimensions_t D = 0>
+    inline distance_t line_segment_dist(const Const_Point_View &p1, const Const_Point_View &p2) const {
+        return std::sqrt(line_segment_dist_sqr<D>(p1, p2));
+    }
+    
+    template<dimensions_t D = 0>
+    inline Interval ball_intersection_interval(const distance_t, const Const_Point_View&, const Const_Point_View&) const;
+};
+
+/*
+ * Non-owning view of a point, i.e., of dimensions() consecutive coordinates in some buffer.
+ */
+class Const_Point_View : public Point_Base<Const_Point_View> {
+protected:
+    coordinate_t *coordinates;
+    dimensions_t dim;
+    
+public:
+    inline Const_Point_View(const coordinate_t *coordinates, const dimensions_t dim) : coordinates{const_cast<coordinate_t*>(coordinates)}, dim{dim} {}
+    inline Const_Point_View(const Point&);
+    
+    inline dimensions_t dimensions() const {
+        return dim;
+    }
+    
+    inline const coordinate_t* data() const {
+        return coordinates;
+    }
+    
+    inline coordinate_t get(const dimensions_t i) const { 
+        return coordinates[i]; 
+    }
+    
+    inline const coordinate_t& operator[](const dimensions_t i) const { 
+        return coordinates[i]; 
+    }
+    
+    inline const coordinate_t* begin() const {
+        return coordinates;
+    }
+    
+    inline const coordinate_t* end() const {
+        return coordinates + dim;
+    }
+};
+
+/*
+ * Mutable view; behaves like a reference, i.e., assignment copies coordinates into the viewed buffer.
+ */
+class Point_View : public Const_Point_View {
+public:
+    inline Point_View(coordinate_t *coordinates, const dimensions_t dim) : Const_Point_View(coordinates, dim) {}
+    inline Point_View(const Point_View&) = default;
+    
+    inline Point_View& operator=(const Point_View &point) {
+        return operator=(static_cast<const Const_Point_View&>(point));
+    }
+    
+    inline Point_View& operator=(const Const_Point_View &point) {
+        std::copy_n(point.data(), dim, coordinates);
+        return *this;
+    }
+    
+    using Const_Point_View::data;
+    using Const_Point_View::operator[];
+    
+    inline coordinate_t* data() {
+        return coordinates;
+    }
+    
+    inline void set(const dimensions_t i, coordinate_t val) {
+        coordinates[i] = val;
+    }
+    
+    inline coordinate_t& operator[](const dimensions_t i) { 
+        return coordinates[i]; 
+    }
+    
+    inline Point_View& operator+=(const Const_Point_View &point) {
+        #pragma omp simd
+        for (dimensions_t i = 0; i < dim; ++i){
+            coordinates[i] += point[i];
+        }
+        return *this;
+    }
+    
+    inline Point_View& operator-=(const Const_Point_View &point) {
+        #pragma omp simd
+        for (dimensions_t i = 0; i < dim; ++i){
+            coordinates[i] -= point[i];
+        }
+        return *this;
+    }
+    
+    inline Point_View& operator/=(const coordinate_t div) {
+        #pragma omp simd
+        for (dimensions_t i = 0; i < dim; ++i){
+            coordinates[i] /= div;
+        }
+        return *this;
+    }
+};
+
+class Point : public Coordinates, public Point_Base<Point> {
 public:    
     inline Point(const dimensions_t d) : Coordinates(d) {}
+    inline Point(const Const_Point_View &point) : Coordinates(point.begin(), point.end()) {}
     
     inline dimensions_t dimensions() const {
         return size();
@@ -51,7 +209,7 @@ public:
         return Coordinates::operator[](i); 
     }
     
-    inline Point& operator+=(const Point &point) {
+    inline Point& operator+=(const Const_Point_View &point) {
         #pragma omp simd
         for (dimensions_t i = 0; i < dimensions(); ++i){
             operator[](i) += point[i];
@@ -59,7 +217,7 @@ public:
         return *this;
     }
     
-    inline Point& operator-=(const Point &point) {
+    inline Point& operator-=(const Const_Point_View &point) {
         #pragma omp simd
         for (dimensions_t i = 0; i < dimensions(); ++i){
             operator[](i) -= point[i];
@@ -75,138 +233,320 @@ public:
         return *this;
     }
     
-    inline Point operator+(const Point &point) const {
-        Point result = *this;
-        #pragma omp simd
-        for (dimensions_t i = 0; i < dimensions(); ++i){
-            result[i] += point[i];
-        }
-        return result;
+    inline auto as_ndarray() const {
+        return py::array_t<coordinate_t>(dimensions(), data());
     }
     
-    inline Point operator-(const Point &point) const {
-        Point result = *this;
-        #pragma omp simd
-        for (dimensions_t i = 0; i < dimensions(); ++i){
-            result[i] -= point[i];
-        }
-        return result;
-    }
+    std::string str() const;
     
-    inline Point operator*(const coordinate_t mult) const {
-        Point result = *this;
-        #pragma omp simd
-        for (dimensions_t i = 0; i < dimensions(); ++i){
-            result[i] *= mult;
-        }
-        return result;
+    std::string repr() const;
+};
+
+inline Const_Point_View::Const_Point_View(const Point &point) : Const_Point_View(point.data(), point.dimensions()) {}
+
+template<class T>
+inline Point Point_Base<T>::operator+(const Const_Point_View &point) const {
+    Point result(dims());
+    const coordinate_t *p = coords();
+    #pragma omp simd
+    for (dimensions_t i = 0; i < dims(); ++i){
+        result[i] = p[i] + point[i];
+    }
+    return result;
+}
+
+template<class T>
+inline Point Point_Base<T>::operator-(const Const_Point_View &point) const {
+    Point result(dims());
+    const coordinate_t *p = coords();
+    #pragma omp simd
+    for (dimensions_t i = 0; i < dims(); ++i){
+        result[i] = p[i] - point[i];
+    }
+    return result;
+}
+
+template<class T>
+inline Point Point_Base<T>::operator*(const coordinate_t mult) const {
+    Point result(dims());
+    const coordinate_t *p = coords();
+    #pragma omp simd
+    for (dimensions_t i = 0; i < dims(); ++i){
+        result[i] = p[i] * mult;
+    }
+    return result;
+}
+
+template<class T>
+inline distance_t Point_Base<T>::operator*(const Const_Point_View &point) const {
+    distance_t result = 0;
+    const coordinate_t *p = coords();
+    #pragma omp simd reduction(+: result)
+    for (dimensions_t i = 0; i < dims(); ++i) {
+        result += p[i] * point[i];
+    }
+    return result;
+}
+
+template<class T>
+inline Point Point_Base<T>::operator/(const coordinate_t div) const {
+    Point result(dims());
+    const coordinate_t *p = coords();
+    #pragma omp simd
+    for (dimensions_t i = 0; i < dims(); ++i){
+        result[i] = p[i] / div;
+    }
+    return result;
+}
+
+template<class T>
+template<dimensions_t D>
+inline distance_t Point_Base<T>::dist_sqr(const Const_Point_View &point) const {
+    distance_t result = 0, temp;
+    const coordinate_t *p = coords(), *q = point.data();
+    const dimensions_t d = D > 0 ? D : dims();
+    #pragma omp simd private(temp) reduction(+: result)
+    for (dimensions_t i = 0; i < d; ++i){
+        temp = p[i] - q[i];
+        result += temp * temp;
+    }
+    return result;
+}
+
+template<class T>
+inline distance_t Point_Base<T>::length_sqr() const {
+    distance_t result = 0;
+    const coordinate_t *p = coords();
+    #pragma omp simd reduction(+: result)
+    for (dimensions_t i = 0; i < dims(); ++i){
+        result += p[i] * p[i];
     }
+    return result;
+}
+
+template<class T>
+inline Point Point_Base<T>::line_segment_point(const Const_Point_View &p2, const parameter_t p) const {
+    Point result(dims());
+    const coordinate_t *p1 = coords();
+    #pragma omp simd
+    for (dimensions_t i = 0; i < dims(); ++i){
+        result[i] = p1[i] * (1 - p) + p2[i] * p;
+    }
+    return result;
+}
+
+template<class T>
+template<dimensions_t D>
+inline distance_t Point_Base<T>::line_segment_dist_sqr(const Const_Point_View &p1, const Const_Point_View &p2) const {
+    const coordinate_t *x = coords(), *s = p1.data(), *e = p2.data();
+    const dimensions_t d = D > 0 ? D : dims();
+    distance_t uu = 0, vu = 0;
+    #pragma omp simd reduction(+: uu, vu)
+    for (dimensions_t i = 0; i < d; ++i){
+        uu += (e[i] - s[i]) * (e[i] - s[i]);
+        vu += (x[i] - s[i]) * (e[i] - s[i]);
+    }
+    parameter_t projection_param = vu / uu;
+    if (projection_param < parameter_t(0)) projection_param = parameter_t(0);
+    else if (projection_param > parameter_t(1)) projection_param = parameter_t(1);
+    distance_t result = 0, temp;
+    #pragma omp simd private(temp) reduction(+: result)
+    for (dimensions_t i = 0; i < d; ++i){
+        temp = s[i] + (e[i] - s[i]) * projection_param - x[i];
+        result += temp * temp;
+    }
+    return result;
+}
+
+template<class T>
+template<dimensions_t D>
+inline Interval Point_Base<T>::ball_intersection_interval(const distance_t distance_sqr, const Const_Point_View &line_start, const Const_Point_View &line_end) const {
+    const coordinate_t *x = coords(), *s = line_start.data(), *e = line_end.data();
+    const dimensions_t d = D > 0 ? D : dims();
+    distance_t uu = 0, vv = 0, uv = 0;
+    #pragma omp simd reduction(+: uu, vv, uv)
+    for (dimensions_t i = 0; i < d; ++i){
+        uu += (e[i] - s[i]) * (e[i] - s[i]);
+        vv += (x[i] - s[i]) * (x[i] - s[i]);
+        uv += (e[i] - s[i]) * (x[i] - s[i]);
+    }
+    const parameter_t ulen_sqr = uu, vlen_sqr = vv;
     
-    inline distance_t operator*(const Point &p) const {
-        distance_t result = 0;
-        #pragma omp simd reduction(+: result)
-        for (dimensions_t i = 0; i < dimensions(); ++i) {
-            result += operator[](i) * p[i];
-        }
-        return result;
+    if (near_eq(ulen_sqr, parameter_t(0))) {
+        if (vlen_sqr <= distance_sqr) return Interval(parameter_t(0), parameter_t(1));
+        else return Interval();
     }
+            
+    const parameter_t p =  -2. * (uv / ulen_sqr), q = vlen_sqr / ulen_sqr - distance_sqr / ulen_sqr;
+    
+    const parameter_t phalf_sqr = p * p / 4., discriminant = phalf_sqr - q;
+    
+    if (discriminant < 0) return Interval();
+    
+    const parameter_t discriminant_sqrt = std::sqrt(discriminant);
     
-    inline Point operator/(const coordinate_t div) const {
-        Point result = *this;
+    const parameter_t minus_p_h = - p / 2., r1 = minus_p_h + discriminant_sqrt, r2 = minus_p_h - discriminant_sqrt;
+    const parameter_t lambda1 = std::min(r1, r2), lambda2 = std::max(r1, r2);
+            
+    return Interval(std::max(parameter_t(0), lambda1), std::min(parameter_t(1), lambda2));
+}
+
+/*
+ * ball_intersection_interval for count pairs of a point and a segment, the k-th pair being x + k * point_stride 
+ * and the segment from s + k * segment_stride to e + k * segment_stride, written to result with the given stride.
+ * The intervals are computed vectorized in double precision; only near-degenerate discriminants, i.e., almost tangent balls, 
+ * and degenerate segments are computed in long double.
+ */
+template<dimensions_t D, class I>
+inline void _ball_intersection_intervals(const distance_t distance_sqr, const coordinate_t *x, const curve_size_t point_stride, 
+                                         const coordinate_t *s, const coordinate_t *e, const curve_size_t segment_stride, const dimensions_t dim,
+                                         const curve_size_t count, I *result, const curve_size_t stride) {
+    const dimensions_t d = D > 0 ? D : dim;
+    
+    // relative size below which the discriminant is recomputed in long double
+    const distance_t tolerance = 1e-8;
+    const curve_size_t block = 256;
+    double begin[block], end[block];
+    bool degenerate[block];
+    
+    for (curve_size_t first = 0; first < count; first += block) {
+        const curve_size_t size = std::min(block, count - first);
+        const coordinate_t *xb = x + first * point_stride, *sb = s + first * segment_stride, *eb = e + first * segment_stride;
+        
         #pragma omp simd
-        for (dimensions_t i = 0; i < dimensions(); ++i){
-            result[i] /= div;
+        for (curve_size_t k = 0; k < size; ++k) {
+            const coordinate_t *xk = xb + k * point_stride, *sk = sb + k * segment_stride, *ek = eb + k * segment_stride;
+            distance_t uu = 0, vv = 0, uv = 0;
+            for (dimensions_t i = 0; i < d; ++i) {
+                uu += (ek[i] - sk[i]) * (ek[i] - sk[i]);
+                vv += (xk[i] - sk[i]) * (xk[i] - sk[i]);
+                uv += (ek[i] - sk[i]) * (xk[i] - sk[i]);
+            }
+            const distance_t minus_p_h = uv / uu, q = (vv - distance_sqr) / uu;
+            const distance_t phalf_sqr = minus_p_h * minus_p_h, discriminant = phalf_sqr - q;
+            const distance_t discriminant_sqrt = std::sqrt(std::max(discriminant, distance_t(0)));
+            
+            degenerate[k] = near_eq(uu, distance_t(0)) or std::abs(discriminant) < tolerance * (phalf_sqr + std::abs(q));
+            begin[k] = discriminant < 0 ? 1 : std::max(distance_t(0), minus_p_h - discriminant_sqrt);
+            end[k] = discriminant < 0 ? 0 : std::min(distance_t(1), minus_p_h + discriminant_sqrt);
         }
-        return result;
-    }
-    
-    inline distance_t dist_sqr(const Point &point) const {
-        distance_t result = 0, temp;
-        #pragma omp simd private(temp) reduction(+: result)
-        for (dimensions_t i = 0; i < dimensions(); ++i){
-            temp = operator[](i) - point[i];
-            result += temp * temp;
+        
+        for (curve_size_t k = 0; k < size; ++k) {
+            if (degenerate[k]) {
+                const Interval interval = Const_Point_View(xb + k * point_stride, d).ball_intersection_interval<D>(distance_sqr, 
+                    Const_Point_View(sb + k * segment_stride, d), Const_Point_View(eb + k * segment_stride, d));
+                result[(first + k) * stride] = I(interval.begin(), interval.end());
+            }
+            else result[(first + k) * stride] = I(begin[k], end[k]);
         }
-        return result;
     }
+}
+
+// free intervals of one segment for count consecutive points of a row-major buffer
+template<dimensions_t D = 0, class I = Interval>
+inline void ball_intersection_intervals(const distance_t distance_sqr, const Const_Point_View &line_start, const Const_Point_View &line_end, 
+                                        const coordinate_t *points, const curve_size_t count, I *result, const curve_size_t stride = 1) {
+    _ball_intersection_intervals<D, I>(distance_sqr, points, line_start.dimensions(), line_start.data(), line_end.data(), 0, line_start.dimensions(), count, result, stride);
+}
+
+// free intervals of one point for the count consecutive segments of the polyline through the points of a row-major buffer
+template<dimensions_t D = 0, class I = Interval>
+inline void ball_intersection_intervals(const distance_t distance_sqr, const Const_Point_View &point, 
+                                        const coordinate_t *points, const curve_size_t count, I *result, const curve_size_t stride = 1) {
+    const dimensions_t d = point.dimensions();
+    _ball_intersection_intervals<D, I>(distance_sqr, point.data(), 0, points, points + d, d, d, count, result, stride);
+}
+
+/*
+ * Iterator over the rows of a row-major coordinate buffer, dereferences to a point view.
+ */
+template<class V, class C>
+class Points_Iterator {
+    C coordinates;
+    dimensions_t dim;
+    
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef V value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef void pointer;
+    typedef V reference;
+    
+    inline Points_Iterator(C coordinates, const dimensions_t dim) : coordinates{coordinates}, dim{dim} {}
     
-    inline distance_t dist(const Point &point) const {
-        return std::sqrt(dist_sqr(point));
+    inline V operator*() const {
+        return V(coordinates, dim);
     }
     
-    inline distance_t length_sqr() const {
-        distance_t result = 0;
-        #pragma omp simd reduction(+: result)
-        for (dimensions_t i = 0; i < dimensions(); ++i){
-            result += operator[](i) * operator[](i);
-        }
-        return result;
+    inline Points_Iterator& operator++() {
+        coordinates += dim;
+        return *this;
     }
     
-    inline distance_t length() const {
-        return std::sqrt(length_sqr());
+    inline Points_Iterator operator++(int) {
+        Points_Iterator result = *this;
+        coordinates += dim;
+        return result;
     }
     
-    inline Point line_segment_point(const Point &p2, const parameter_t p) const {
-        return *this * (1-p) + p2 * p;
+    inline Points_Iterator operator+(const difference_type n) const {
+        return Points_Iterator(coordinates + n * difference_type(dim), dim);
     }
     
-    inline distance_t line_segment_dist_sqr(const Point &p1, const Point &p2) const {
-        const Vector u = p2 - p1;
-        parameter_t projection_param = (*this - p1) * u / (u * u);
-        if (projection_param < parameter_t(0)) projection_param = parameter_t(0);
-        else if (projection_param > parameter_t(1)) projection_param = parameter_t(1);
-        const Point projection = p1 + u * projection_param;
-        return projection.dist_sqr(*this);
+    inline bool operator==(const Points_Iterator &other) const {
+        return coordinates == other.coordinates;
     }
     
-    inline distance_t line_segment_dist(const Point &p1, const Point &p2) const {
-        return std::sqrt(line_segment_dist(p1, p2));
+    inline bool operator!=(const Points_Iterator &other) const {
+        return coordinates != other.coordinates;
     }
+};
+
+/*
+ * Points are stored row-major in one contiguous buffer. The buffer is either owned and shared between copies
+ * until one of them is modified (copy-on-write), or borrowed from elsewhere, e.g., a numpy array, and kept alive by owner.
+ * Non-const access always works on an owned buffer that is not shared.
+ * Non-const access is not thread-safe, as it may copy the buffer first: parallel loops read points through const references
+ * and write through a pointer taken before the loop.
+ */
+class Points {
+    dimensions_t dim;
+    curve_size_t number_points = 0;
+    std::shared_ptr<Coordinates> storage;
+    std::shared_ptr<const void> owner;
+    coordinate_t *coordinates = nullptr;
     
-    inline Interval ball_intersection_interval(const distance_t distance_sqr, const Point &line_start, const Point &line_end) const {
-        const Vector u = line_end-line_start, v = *this - line_start;
-        const parameter_t ulen_sqr = u.length_sqr(), vlen_sqr = v.length_sqr();
-        
-        if (near_eq(ulen_sqr, parameter_t(0))) {
-            if (vlen_sqr <= distance_sqr) return Interval(parameter_t(0), parameter_t(1));
-            else return Interval();
-        }
-                
-        const parameter_t p =  -2. * ((u * v) / ulen_sqr), q = vlen_sqr / ulen_sqr - distance_sqr / ulen_sqr;
-        
-        const parameter_t phalf_sqr = p * p / 4., discriminant = phalf_sqr - q;
-        
-        if (discriminant < 0) return Interval();
-        
-        const parameter_t discriminant_sqrt = std::sqrt(discriminant);
-        
-        const parameter_t minus_p_h = - p / 2., r1 = minus_p_h + discriminant_sqrt, r2 = minus_p_h - discriminant_sqrt;
-        const parameter_t lambda1 = std::min(r1, r2), lambda2 = std::max(r1, r2);
-                
-        return Interval(std::max(parameter_t(0), lambda1), std::min(parameter_t(1), lambda2));
+    inline std::shared_ptr<const void> buffer() const {
+        return storage ? std::shared_ptr<const void>(storage) : owner;
     }
     
-     inline auto as_ndarray() const {
-        py::list l;
-        for (const coordinate_t &elem : *this) {
-            l.append(elem);
+    // copies a borrowed or shared buffer, so that this is its only owner
+    inline void detach() {
+        if (owner or not storage or storage.use_count() > 1) {
+            storage = std::make_shared<Coordinates>(coordinates, coordinates + number_points * dim);
+            owner.reset();
+            coordinates = storage->data();
         }
-        return py::array_t<coordinate_t>(l);
     }
     
-    std::string str() const;
-    
-    std::string repr() const;
-};
-
-class Points : public std::vector<Point> {
-    dimensions_t dim;
+protected:
+    py::array_t<coordinate_t> as_ndarray_view(const curve_size_t, const curve_size_t) const;
     
 public:
+    typedef Points_Iterator<Point_View, coordinate_t*> iterator;
+    typedef Points_Iterator<Const_Point_View, const coordinate_t*> const_iterator;
+    
     inline Points(const dimensions_t dim) : dim{dim} {}
-    inline Points(const curve_size_t m, const dimensions_t dim) : std::vector<Point>(m, Point(dim)), dim{dim} {}
-    inline Points(const curve_size_t m, const Point& p) : std::vector<Point>(m, p), dim{p.dimensions()} {}
+    inline Points(const curve_size_t m, const dimensions_t dim) : dim{dim}, number_points{m}, storage{std::make_shared<Coordinates>(m * dim)}, coordinates{storage->data()} {}
+    inline Points(const curve_size_t m, const Point& p) : dim{p.dimensions()}, number_points{m}, storage{std::make_shared<Coordinates>(m * p.dimensions())}, coordinates{storage->data()} {
+        for (curve_size_t i = 0; i < m; ++i) {
+            std::copy(p.begin(), p.end(), coordinates + i * dim);
+        }
+    }
+    inline Points(const coordinate_t *coordinates, const curve_size_t m, const dimensions_t dim, const std::shared_ptr<const void> &owner) : 
+        dim{dim}, number_points{m}, owner{owner}, coordinates{const_cast<coordinate_t*>(coordinates)} {}
+    inline Points(const Points &points, const curve_size_t first, const curve_size_t m) : 
+        dim{points.dim}, number_points{m}, owner{points.buffer()}, coordinates{points.coordinates + first * points.dim} {}
     
     inline Point centroid() const {
         if (empty()) return Point(0);
@@ -219,7 +559,7 @@ public:
         return mean;
     }
     
-    inline void add(Point &point) {
+    inline void add(const Point &point) {
         if (point.dimensions() != dim) {
             std::cerr << "Wrong number of dimensions; expected " << dim << " dimensions and got " << point.dimensions() << " dimensions." << std::endl;
             return;
@@ -227,8 +567,76 @@ public:
         push_back(point);
     }
     
-    inline Point& get(const curve_size_t i) { 
-        return Points::operator[](i); 
+    inline void push_back(const Const_Point_View &point) {
+        const coordinate_t *source = point.data();
+        const std::less<const coordinate_t*> less;
+        // the point may live in our own buffer, which moves when detaching or growing
+        const bool inside = not less(source, coordinates) and less(source, coordinates + number_points * dim);
+        const auto offset = source - coordinates;
+        detach();
+        storage->resize((number_points + 1) * dim);
+        coordinates = storage->data();
+        std::copy_n(inside ? coordinates + offset : source, dim, coordinates + number_points * dim);
+        ++number_points;
+    }
+    
+    inline void reserve(const curve_size_t m) {
+        detach();
+        storage->reserve(m * dim);
+        coordinates = storage->data();
+    }
+    
+    inline Point_View operator[](const curve_size_t i) {
+        detach();
+        return Point_View(coordinates + i * dim, dim);
+    }
+    
+    inline Const_Point_View operator[](const curve_size_t i) const {
+        return Const_Point_View(coordinates + i * dim, dim);
+    }
+    
+    inline Const_Point_View at(const curve_size_t i) const {
+        if (i >= number_points) throw std::out_of_range("point index out of range");
+        return operator[](i);
+    }
+    
+    inline Point get(const curve_size_t i) const { 
+        return operator[](i); 
+    }
+    
+    inline iterator begin() {
+        detach();
+        return iterator(coordinates, dim);
+    }
+    
+    inline iterator end() {
+        detach();
+        return iterator(coordinates + number_points * dim, dim);
+    }
+    
+    inline const_iterator begin() const {
+        return const_iterator(coordinates, dim);
+    }
+    
+    inline const_iterator end() const {
+        return const_iterator(coordinates + number_points * dim, dim);
+    }
+    
+    inline coordinate_t* data() {
+        detach();
+        return coordinates;
+    }
+    
+    inline const coordinate_t* data() const {
+        return coordinates;
+    }
+    
+    inline curve_size_t size() const {
+        return number_points;
+    }
+    
+    inline bool empty() const {
+        return number_points == 0;
     }
     
     inline curve_size_t number() const {
@@ -239,12 +647,8 @@ public:
         return dim;
     }
     
-    inline auto as_ndarray() const {
-        py::list l;
-        for (const Point &elem : *this) {
-            l.append(elem.as_ndarray());
-        }
-        return py::array_t<coordinate_t>(l);
+    inline py::array_t<coordinate_t> as_ndarray() const {
+        return as_ndarray_view(0, size());
     }
     
     std::string str() const;
@@ -252,5 +656,7 @@ public:
     std::string repr() const;
 };
 
-std::ostream& operator<<(std::ostream&, const Point&);
+std::shared_ptr<const void> share_array(const py::array&);
+
+std::ostream& operator<<(std::ostream&, const Const_Point_View&);
 std::ostream& operator<<(std::ostream&, const Points&);
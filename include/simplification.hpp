@@ -36,18 +36,19 @@ namespace Simplification {
 
 class Subcurve_Shortcut_Graph {
 
-    Curve& curve;
+    const Curve curve;
+    const Config::Options options;
     std::vector<std::vector<distance_t>> edges;
     
 public:
     
-    Subcurve_Shortcut_Graph(const Curve&);
+    Subcurve_Shortcut_Graph(const Curve&, const Config::Options& = Config::Options());
     
     Curve minimum_error_simplification(const curve_size_t) const;
 };
 
-Curve approximate_minimum_link_simplification(const Curve&, const distance_t);
-Curve approximate_minimum_error_simplification(const Curve&, const curve_size_t);
+Curve approximate_minimum_link_simplification(const Curve&, const distance_t, const Config::Options& = Config::Options());
+Curve approximate_minimum_error_simplification(const Curve&, const curve_size_t, const Config::Options& = Config::Options());
  
 }
 
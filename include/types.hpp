@@ -27,7 +27,9 @@ typedef unsigned long curve_number_t; // Number of curves
 
 class Point;
 class Curve;
-class Interval;
+template<class T> class Basic_Interval;
+typedef Basic_Interval<parameter_t> Interval; // Free intervals
+typedef Basic_Interval<double> Compact_Interval; // Free intervals of the compact free space
 
 struct PDistance {
   
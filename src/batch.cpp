@@ -0,0 +1,236 @@
+/*
+Copyright 2020-2021 Dennis Rohde
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <memory>
+#include <limits>
+#include <atomic>
+#include <numeric>
+#include <algorithm>
+
+#ifdef WITH_OMP
+#include <omp.h>
+#endif
+
+#include "batch.hpp"
+
+namespace Batch {
+
+// the distance functions print with verbosity > 1, which needs the GIL and must not happen outside the main thread
+static inline bool parallel(const Config::Options &options) {
+    return options.verbosity < 2;
+}
+
+// with fewer curves than threads, the threads rather work on the simplification of one curve together
+static inline bool parallel(const curve_number_t number_curves, const Config::Options &options) {
+#ifdef WITH_OMP
+    return parallel(options) and number_curves >= static_cast<curve_number_t>(omp_get_max_threads());
+#else
+    return false;
+#endif
+}
+
+static inline bool comparable(const Curve &curve1, const Curve &curve2) {
+    return curve1.complexity() > 1 and curve2.complexity() > 1 and curve1.dimensions() == curve2.dimensions();
+}
+
+static bool comparable(const Curves &curves, const dimensions_t dimensions) {
+    for (const Curve &curve : curves) {
+        if (curve.complexity() < 2 or curve.dimensions() != dimensions) return false;
+    }
+    return true;
+}
+
+static void warn_incomparable() {
+    py::print("WARNING: comparison possible only for curves of at least two points and equal number of dimensions, their distance is NaN");
+}
+
+distance_t distance(const Curve &curve1, const Curve &curve2, const unsigned int distance_func, const Config::Options &options) {
+    if (not comparable(curve1, curve2)) return std::numeric_limits<distance_t>::signaling_NaN();
+    
+    switch (distance_func) {
+        case 0:
+            return Frechet::Continuous::distance(curve1, curve2, false, Frechet::Continuous::Budget(), options).value;
+        case 1:
+            return Frechet::Discrete::distance(curve1, curve2).value;
+        case 2:
+            return Dynamic_Time_Warping::Discrete::distance(curve1, curve2, std::numeric_limits<distance_t>::infinity(), options, false).value;
+        default:
+            return std::numeric_limits<distance_t>::signaling_NaN();
+    }
+}
+
+void _distances(const Curve &query, const Curves &curves, distance_t *result, const unsigned int distance_func, const Config::Options &options) {
+    const curve_number_t n = curves.size();
+    
+    #pragma omp parallel for schedule(dynamic) if (parallel(options))
+    for (curve_number_t i = 0; i < n; ++i) {
+        result[i] = distance(query, curves[i], distance_func, options);
+    }
+}
+
+void _pairwise_distances(const Curves &curves1, const Curves &curves2, distance_t *result, const unsigned int distance_func, const Config::Options &options) {
+    const curve_number_t n = curves1.size(), m = curves2.size();
+    
+    #pragma omp parallel for schedule(dynamic) if (parallel(options))
+    for (curve_number_t k = 0; k < n * m; ++k) {
+        result[k] = distance(curves1[k / m], curves2[k % m], distance_func, options);
+    }
+}
+
+void _pairwise_distances(const Curves &curves, distance_t *result, const unsigned int distance_func, const Config::Options &options) {
+    const curve_number_t n = curves.size();
+    
+    // rows get shorter, so they are handed out one at a time
+    #pragma omp parallel for schedule(dynamic, 1) if (parallel(options))
+    for (curve_number_t i = 0; i < n; ++i) {
+        result[i * n + i] = curves[i].complexity() > 1 ? 0 : std::numeric_limits<distance_t>::signaling_NaN();
+        for (curve_number_t j = i + 1; j < n; ++j) {
+            result[i * n + j] = result[j * n + i] = distance(curves[i], curves[j], distance_func, options);
+        }
+    }
+}
+
+void _less_than_or_equal(const Curve &query, const Curves &curves, const distance_t distance, bool *result, const bool discrete, const Config::Options &options) {
+    const curve_number_t n = curves.size();
+    
+    #pragma omp parallel for schedule(dynamic) if (parallel(options))
+    for (curve_number_t i = 0; i < n; ++i) {
+        if (not comparable(query, curves[i])) result[i] = false;
+        else if (discrete) result[i] = Frechet::Discrete::less_than_or_equal(distance, query, curves[i]);
+        else result[i] = Frechet::Continuous::less_than_or_equal(distance, query, curves[i], options);
+    }
+}
+
+py::array_t<distance_t> distances(const Curve &query, const Curves &curves, const unsigned int distance_func, const Config::Options &options) {
+    py::array_t<distance_t> result(curves.size());
+    distance_t *values = result.mutable_data();
+    
+    if (query.complexity() < 2 or not comparable(curves, query.dimensions())) warn_incomparable();
+    
+    std::unique_ptr<py::gil_scoped_release> release;
+    if (parallel(options)) release = std::make_unique<py::gil_scoped_release>();
+    _distances(query, curves, values, distance_func, options);
+    
+    return result;
+}
+
+py::array_t<distance_t> pairwise_distances(const Curves &curves1, const Curves &curves2, const unsigned int distance_func, const Config::Options &options) {
+    py::array_t<distance_t> result({curves1.size(), curves2.size()});
+    distance_t *values = result.mutable_data();
+    
+    if (not curves1.empty() and not curves2.empty()) {
+        const dimensions_t dimensions = curves1.front().dimensions();
+        if (not comparable(curves1, dimensions) or not comparable(curves2, dimensions)) warn_incomparable();
+    }
+    
+    std::unique_ptr<py::gil_scoped_release> release;
+    if (parallel(options)) release = std::make_unique<py::gil_scoped_release>();
+    _pairwise_distances(curves1, curves2, values, distance_func, options);
+    
+    return result;
+}
+
+py::array_t<distance_t> pairwise_distances(const Curves &curves, const unsigned int distance_func, const Config::Options &options) {
+    py::array_t<distance_t> result({curves.size(), curves.size()});
+    distance_t *values = result.mutable_data();
+    
+    if (not curves.empty() and not comparable(curves, curves.front().dimensions())) warn_incomparable();
+    
+    std::unique_ptr<py::gil_scoped_release> release;
+    if (parallel(options)) release = std::make_unique<py::gil_scoped_release>();
+    _pairwise_distances(curves, values, distance_func, options);
+    
+    return result;
+}
+
+py::array_t<bool> less_than_or_equal(const Curve &query, const Curves &curves, const distance_t distance, const bool discrete, const Config::Options &options) {
+    py::array_t<bool> result(curves.size());
+    bool *values = result.mutable_data();
+    
+    if (query.complexity() < 2 or not comparable(curves, query.dimensions())) py::print("WARNING: comparison possible only for curves of at least two points and equal number of dimensions, their result is False");
+    
+    std::unique_ptr<py::gil_scoped_release> release;
+    if (parallel(options)) release = std::make_unique<py::gil_scoped_release>();
+    _less_than_or_equal(query, curves, distance, values, discrete, options);
+    
+    return result;
+}
+
+Curve simplification(const Curve &curve, const curve_size_t l, const bool approx, const Config::Options &options) {
+    Curve result = approx ? Frechet::Continuous::Simplification::approximate_minimum_error_simplification(curve, l, options) : 
+        Frechet::Continuous::Simplification::Subcurve_Shortcut_Graph(curve, options).minimum_error_simplification(l);
+    result.set_name("Simplification of " + curve.get_name());
+    return result;
+}
+
+void _simplify(const Curves &curves, Curves &result, const curve_size_t l, const bool approx, const Config::Options &options, const std::function<bool(const curve_number_t)> &progress) {
+    const curve_number_t n = curves.size();
+    
+    // the time taken grows quickly with the complexity, so the longest curves start first
+    std::vector<curve_number_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](const curve_number_t i, const curve_number_t j) { return curves[i].complexity() > curves[j].complexity(); });
+    
+    std::atomic<curve_number_t> done{0};
+    std::atomic<bool> stopped{false}, reporting{false};
+    // only written by the thread that holds reporting
+    curve_number_t reported = 0;
+    
+    #pragma omp parallel for schedule(dynamic, 1) if (parallel(n, options))
+    for (curve_number_t k = 0; k < n; ++k) {
+        if (stopped) continue;
+        const curve_number_t i = order[k];
+        result[i] = simplification(curves[i], l, approx, options);
+        ++done;
+        // whichever thread finishes a curve reports, unless another one is reporting already, so the counts only grow and no thread waits
+        if (progress and not reporting.exchange(true)) {
+            const curve_number_t finished = done;
+            if (finished > reported and not stopped) {
+                reported = finished;
+                if (not progress(finished)) stopped = true;
+            }
+            reporting = false;
+        }
+    }
+    
+    if (progress and not stopped and reported < n) progress(n);
+}
+
+Curves simplify(const Curves &curves, const curve_size_t l, const bool approx, const py::object &progress, const Config::Options &options) {
+    Curves result(curves.size(), l, curves.dimensions());
+    const curve_number_t n = curves.size();
+    
+    std::unique_ptr<py::error_already_set> error;
+    std::function<bool(const curve_number_t)> report;
+    if (not progress.is_none()) {
+        report = [&](const curve_number_t done) {
+            py::gil_scoped_acquire acquire;
+            try {
+                progress(done, n);
+            } catch (py::error_already_set &e) {
+                error = std::make_unique<py::error_already_set>(std::move(e));
+                return false;
+            }
+            return true;
+        };
+    }
+    
+    {
+        std::unique_ptr<py::gil_scoped_release> release;
+        if (parallel(options)) release = std::make_unique<py::gil_scoped_release>();
+        _simplify(curves, result, l, approx, options, report);
+    }
+    
+    if (error) throw *error;
+    
+    return result;
+}
+
+}
@@ -9,13 +9,43 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 */
 
 #include<ctime>
+#include<functional>
 
 #include "clustering.hpp"
 
 namespace Clustering {
 
-Distance_Matrix distances;
-Curves simplifications;
+static inline void _combine(std::size_t &seed, const std::size_t value) {
+    seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+// hash of the complexities and coordinates of the curves
+static std::size_t _fingerprint(const Curves &curves) {
+    std::size_t result = curves.size();
+    for (const Curve &curve : curves) {
+        _combine(result, curve.complexity());
+        const coordinate_t *values = curve.data();
+        for (std::size_t k = 0; k < curve.complexity() * curve.dimensions(); ++k) _combine(result, std::hash<coordinate_t>()(values[k]));
+    }
+    return result;
+}
+
+/*
+ * Caches of the clusterings whose results are still alive, by their input and the parameters that determine the simplifications and distances,
+ * so that consecutive calls of different pipelines do not share a cache; the cache of the last clustering is kept alive in any case.
+ * The clustering holds the GIL, so no two calls change these at once.
+ */
+static std::unordered_map<std::size_t, std::weak_ptr<Cache>> caches;
+static std::shared_ptr<Cache> last_cache;
+
+static std::size_t _cache_key(const std::size_t input, const curve_size_t ell, const unsigned int distance_func, const bool fast_simplification, const bool use_distance_matrix) {
+    std::size_t result = input;
+    _combine(result, ell);
+    _combine(result, distance_func);
+    _combine(result, fast_simplification);
+    _combine(result, use_distance_matrix);
+    return result;
+}
 
 void Distance_Matrix::print() const {
     for (const auto &row : *this) {
@@ -30,6 +60,10 @@ const unsigned int Clustering_Result::get_distance_func() const {
     return distance_func;
 }
 
+const Config::Options& Clustering_Result::get_options() const {
+    return options;
+}
+
 const Curve& Clustering_Result::get(const curve_number_t i) const {
     return centers[i];
 }
@@ -55,12 +89,14 @@ Curves::const_iterator Clustering_Result::cend() const {
 }
 
 void Clustering_Result::compute_assignment(const Curves &in, const bool consecutive_call) {
-    if (Config::verbosity > 0) py::print("Clustering Result: computing assignment");
+    if (options.verbosity > 0) py::print("Clustering Result: computing assignment");
     assignment = std::make_unique<Cluster_Assignment>(*this, in, distance_func);
-    if (consecutive_call and in.size() == distances.size()) {
-        for (curve_number_t i = 0; i < in.size(); ++i) assignment->operator[](_nearest_center(i, in, simplifications, center_indices, distances, distance_func)).push_back(i);
+    consecutive_assignment = consecutive_call and cache and in.size() == cache->simplifications.size() and (cache->distances.size() == in.size() or not options.use_distance_matrix) and cache->input == _fingerprint(in);
+    if (consecutive_call and not consecutive_assignment) py::print("WARNING: consecutive_call is used with input other than the clustering's; ignoring!");
+    if (consecutive_assignment) {
+        for (curve_number_t i = 0; i < in.size(); ++i) assignment->operator[](_nearest_center(i, in, cache->simplifications, center_indices, cache->distances, nullptr, distance_func, options)).push_back(i);
     } else {
-        if (Config::use_distance_matrix) distances = Distance_Matrix(in.size(), centers.size());
+        if (options.use_distance_matrix) assignment_distances = Distance_Matrix(in.size(), centers.size());
         
         Curve_Numbers ncenter_indices = Curve_Numbers(centers.size());
         
@@ -68,7 +104,7 @@ void Clustering_Result::compute_assignment(const Curves &in, const bool consecut
             ncenter_indices[i] = i;
 
         for (curve_number_t i = 0; i < in.size(); ++i) {
-            assignment->operator[](_nearest_center(i, in, centers, ncenter_indices, distances, distance_func)).push_back(i);
+            assignment->operator[](_nearest_center(i, in, centers, ncenter_indices, assignment_distances, nullptr, distance_func, options)).push_back(i);
         }
     }
 }
@@ -77,8 +113,25 @@ void Clustering_Result::set_center_indices(const Curve_Numbers &pcenter_indices)
     center_indices = pcenter_indices;
 }
 
+void Clustering_Result::set_cache(const std::shared_ptr<Cache> &pcache) {
+    cache = pcache;
+}
+
+const Distance_Matrix& Clustering_Result::get_assignment_distances() const {
+    return consecutive_assignment ? cache->distances : assignment_distances;
+}
+
+// distance of curve to the center of the cluster, when the assignment has stored it
+const PDistance* Clustering_Result::assignment_distance(const curve_number_t curve, const curve_number_t cluster) const {
+    if (not options.use_distance_matrix) return nullptr;
+    const auto &distances = get_assignment_distances();
+    const curve_number_t center = consecutive_assignment ? center_indices[cluster] : cluster;
+    if (curve >= distances.size() or center >= distances[curve].size() or not *distances[curve][center]) return nullptr;
+    return distances[curve][center].get();
+}
+
 py::list Clustering_Result::compute_center_enclosing_balls(const Curves &in, const bool consecutive_call) {
-    if (Config::verbosity > 1) py::print("Clustering Result: computing enclosing balls");
+    if (options.verbosity > 1) py::print("Clustering Result: computing enclosing balls");
     
     py::list result;
     
@@ -94,7 +147,7 @@ py::list Clustering_Result::compute_center_enclosing_balls(const Curves &in, con
     Points tpoints(0);
     
     for (curve_number_t i = 0; i < size(); ++i) {
-        if (Config::verbosity > 2) py::print("Clustering Result: computing points for center ", i);
+        if (options.verbosity > 2) py::print("Clustering Result: computing points for center ", i);
         
         py::list center_list;
         const Curve &center_curve = get(i);
@@ -103,43 +156,43 @@ py::list Clustering_Result::compute_center_enclosing_balls(const Curves &in, con
             ii = (*assignment)[i][j];
             const Curve &input_curve = in[ii];
             
-            if (consecutive_call) jj = center_indices[i];
+            if (consecutive_assignment) jj = center_indices[i];
             else jj = i;
             
             switch (distance_func) {
                 case 0:
-                    if (Config::use_distance_matrix) {
-                        const auto &dist = dynamic_cast<const Frechet::Continuous::Distance&>(*distances[ii][jj]);
-                        tpoints = Frechet::Continuous::vertices_matching_points(input_curve, center_curve, dist);
+                    if (options.use_distance_matrix) {
+                        const auto &dist = dynamic_cast<const Frechet::Continuous::Distance&>(*get_assignment_distances()[ii][jj]);
+                        tpoints = Frechet::Continuous::vertices_matching_points(input_curve, center_curve, dist, options);
                     } else {
-                        const Frechet::Continuous::Distance dist = Frechet::Continuous::distance(input_curve, center_curve);
-                        tpoints = Frechet::Continuous::vertices_matching_points(input_curve, center_curve, dist);
+                        const Frechet::Continuous::Distance dist = Frechet::Continuous::distance(input_curve, center_curve, false, Frechet::Continuous::Budget(), options);
+                        tpoints = Frechet::Continuous::vertices_matching_points(input_curve, center_curve, dist, options);
                     }
                     break;
                 case 1:
                     break;
                 case 2:
-                    if (Config::use_distance_matrix) {
-                        const auto &dist = dynamic_cast<const Dynamic_Time_Warping::Discrete::Distance&>(*distances[ii][jj]);
-                        tpoints = Dynamic_Time_Warping::Discrete::vertices_matching_points(input_curve, center_curve, dist);
+                    if (options.use_distance_matrix) {
+                        const auto &dist = dynamic_cast<const Dynamic_Time_Warping::Discrete::Distance&>(*get_assignment_distances()[ii][jj]);
+                        tpoints = Dynamic_Time_Warping::Discrete::vertices_matching_points(input_curve, center_curve, dist, options);
                     } else {
-                        const Dynamic_Time_Warping::Discrete::Distance dist = Dynamic_Time_Warping::Discrete::distance(input_curve, center_curve);
-                        tpoints = Dynamic_Time_Warping::Discrete::vertices_matching_points(input_curve, center_curve, dist);
+                        const Dynamic_Time_Warping::Discrete::Distance dist = Dynamic_Time_Warping::Discrete::distance(input_curve, center_curve, std::numeric_limits<distance_t>::infinity(), options);
+                        tpoints = Dynamic_Time_Warping::Discrete::vertices_matching_points(input_curve, center_curve, dist, options);
                     }
                     break;
                 default:
                     py::print("not implemented!");
             }
             
-            if (Config::verbosity > 2) py::print("Clustering Result: collecting matching points for center ", i);
+            if (options.verbosity > 2) py::print("Clustering Result: collecting matching points for center ", i);
 
             for (curve_size_t k = 0; k < center_curve.complexity(); ++k) { 
-                if (Config::verbosity > 3) py::print("Clustering Result: collecting matching points for center ", i, " vertex ", k);
+                if (options.verbosity > 3) py::print("Clustering Result: collecting matching points for center ", i, " vertex ", k);
                 center_matching_points[i][k].push_back(tpoints.at(k));
             }
         }
         
-        if (Config::verbosity > 2) py::print("Clustering Result: Computing input for stabbing algorithm");
+        if (options.verbosity > 2) py::print("Clustering Result: Computing input for stabbing algorithm");
         
         for (curve_size_t k = 0; k < center_curve.complexity(); ++k) {
             py::list b_r;
@@ -156,7 +209,7 @@ py::list Clustering_Result::compute_center_enclosing_balls(const Curves &in, con
                     break;
                 case 2:
                     {
-                        if (Config::verbosity > 2) py::print("Clustering Result: Computing mean of matching points for vertex ", k);
+                        if (options.verbosity > 2) py::print("Clustering Result: Computing mean of matching points for vertex ", k);
                         const auto mean = center_matching_points[i][k].centroid();
                         b_r.append(mean.as_ndarray());
                         b_r.append(0);
@@ -184,15 +237,17 @@ curve_number_t Cluster_Assignment::get(const curve_number_t i, const curve_numbe
 }
 
 distance_t Cluster_Assignment::distance(const curve_number_t i, const curve_number_t j) const {
-    if (Config::use_distance_matrix) return distances[i][j]->value;
+    const Config::Options &options = clustering_result.get_options();
+    const PDistance *known = clustering_result.assignment_distance((*this)[i][j], i);
+    if (known) return known->value;
     else {
         switch (distance_func) {
             case 0:
-                return Frechet::Continuous::distance(clustering_result.get(i), assignment_curves[(*this)[i][j]]).value;
+                return Frechet::Continuous::distance(clustering_result.get(i), assignment_curves[(*this)[i][j]], false, Frechet::Continuous::Budget(), options).value;
             case 1:
                 return Frechet::Discrete::distance(clustering_result.get(i), assignment_curves[(*this)[i][j]]).value;
             case 2:
-                return Dynamic_Time_Warping::Discrete::distance(clustering_result.get(i), assignment_curves[(*this)[i][j]]).value;
+                return Dynamic_Time_Warping::Discrete::distance(clustering_result.get(i), assignment_curves[(*this)[i][j]], std::numeric_limits<distance_t>::infinity(), options, false).value;
             default:
                 return std::numeric_limits<distance_t>::signaling_NaN();
         }
@@ -200,59 +255,70 @@ distance_t Cluster_Assignment::distance(const curve_number_t i, const curve_numb
 }
 
 Clustering_Result kl_cluster(const curve_number_t num_centers, const curve_size_t ell, const Curves &in, unsigned int local_search = 0,
-                             const bool median = false, const bool consecutive_call = false, const bool random_start_center = true, const bool fast_simplification = false, const unsigned int distance_func = 0) {
+                             const bool median = false, const bool consecutive_call = false, const bool random_start_center = true, const bool fast_simplification = false, const unsigned int distance_func = 0, Config::Options options = Config::Options()) {
     
     const auto start = std::clock();
-    Clustering_Result result(distance_func);
     
-    if (in.empty()) return result;
+    if (in.empty()) return Clustering_Result(distance_func, options);
     
     std::size_t memory_distance_matrix = std::pow(in.size(), 2) * (sizeof(distance_t) + 3 * sizeof(double) + ell * in.get_m() * 2 * sizeof(curve_number_t) + sizeof(std::size_t)), 
-        memory_available = .666 * Config::available_memory;
+        memory_available = .666 * options.available_memory;
         
-    if (memory_distance_matrix > memory_available and Config::use_distance_matrix == true) {
+    // only this clustering and its result go without the distance matrix, the global setting stays as it is
+    if (memory_distance_matrix > memory_available and options.use_distance_matrix == true) {
         py::print("KL_CLUST: WARNING distance preprocessing requires more memory (", memory_distance_matrix * 1e-9, "GB) than available (", memory_available * 1e-9, "GB), consecutive_call will NOT be available");
-        Config::use_distance_matrix = false;
+        options.use_distance_matrix = false;
     }
-
-    if (not consecutive_call) {
-        if (Config::use_distance_matrix) {
-            if (Config::verbosity > 0) py::print("KL_CLUST: allocating ", in.size(), " x ", in.size(), " distance_matrix");
-            distances = Distance_Matrix(in.size(), in.size());
-        }
-        if (Config::verbosity > 0) py::print("KL_CLUST: allocating space for ", in.size(), " simplifications, each of complexity ", ell);
-        simplifications = Curves(in.size(), ell, in.dimensions());
-    } else if (Config::use_distance_matrix) {
-        if (distances.empty()) {
-            py::print("WARNING: consecutive_call is used wrongly");
-            if (Config::verbosity > 0) py::print("KL_CLUST: allocating ", in.size(), " x ", in.size(), " distance_matrix");
-            distances = Distance_Matrix(in.size(), in.size());
-            if (Config::verbosity > 0) py::print("KL_CLUST: allocating space for ", in.size(), " simplifications, each of complexity ", ell);
-            simplifications = Curves(in.size(), ell, in.dimensions());
-        }
-        if (distances.size() != in.size()) {
-            py::print("WARNING: you have tried to use 'consecutive_call = true' with different input; ignoring!");
-            if (Config::verbosity > 0) py::print("KL_CLUST: allocating ", in.size(), " x ", in.size(), " distance_matrix");
-            distances = Distance_Matrix(in.size(), in.size());
-            if (Config::verbosity > 0) py::print("KL_CLUST: allocating space for ", in.size(), " simplifications, each of complexity ", ell);
-            simplifications = Curves(in.size(), ell, in.dimensions());
+    
+    Clustering_Result result(distance_func, options);
+    
+    const std::size_t input = _fingerprint(in), key = _cache_key(input, ell, distance_func, fast_simplification, options.use_distance_matrix);
+    std::shared_ptr<Cache> cache;
+    if (consecutive_call) {
+        const auto found = caches.find(key);
+        if (found != caches.end()) cache = found->second.lock();
+        if (not cache) {
+            if (not last_cache) py::print("WARNING: consecutive_call is used wrongly");
+            else py::print("WARNING: you have tried to use 'consecutive_call = true' with different input; ignoring!");
         }
     }
+    if (not cache) {
+        cache = std::make_shared<Cache>();
+        cache->input = input;
+        if (options.verbosity > 0) py::print("KL_CLUST: allocating space for ", in.size(), " simplifications, each of complexity ", ell);
+        cache->simplifications = Curves(in.size(), ell, in.dimensions());
+    }
+    if (options.use_distance_matrix and cache->distances.size() != in.size()) {
+        if (options.verbosity > 0) py::print("KL_CLUST: allocating ", in.size(), " x ", in.size(), " distance_matrix");
+        cache->distances = Distance_Matrix(in.size(), in.size());
+    }
+    for (auto it = caches.begin(); it != caches.end();) {
+        if (it->second.expired()) it = caches.erase(it);
+        else ++it;
+    }
+    caches[key] = cache;
+    last_cache = cache;
+    result.set_cache(cache);
+    
+    Distance_Matrix &distances = cache->distances;
+    Curves &simplifications = cache->simplifications;
 
     Curve_Numbers centers;
+    // envelopes of the simplifications, only valid for this call
+    Envelopes envelopes;
     
     const auto simplify = [&](const curve_number_t i) {
         switch (distance_func) {
             case 0:
                 {
                 if (fast_simplification) {
-                    if (Config::verbosity > 0) py::print("KL_CLUST: computing approximate vertex restricted minimum error simplification");
-                    auto simplified_curve = Frechet::Continuous::Simplification::approximate_minimum_error_simplification(const_cast<Curve&>(in[i]), ell);
+                    if (options.verbosity > 0) py::print("KL_CLUST: computing approximate vertex restricted minimum error simplification");
+                    auto simplified_curve = Frechet::Continuous::Simplification::approximate_minimum_error_simplification(in[i], ell, options);
                     simplified_curve.set_name("Simplification of " + in[i].get_name());
                     return simplified_curve;
                 } else {
-                    if (Config::verbosity > 0) py::print("KL_CLUST: computing exact vertex restricted minimum error simplification");
-                    Frechet::Continuous::Simplification::Subcurve_Shortcut_Graph graph(const_cast<Curve&>(in[i]));
+                    if (options.verbosity > 0) py::print("KL_CLUST: computing exact vertex restricted minimum error simplification");
+                    Frechet::Continuous::Simplification::Subcurve_Shortcut_Graph graph(in[i], options);
                     auto simplified_curve = graph.minimum_error_simplification(ell);
                     simplified_curve.set_name("Simplification of " + in[i].get_name());
                     return simplified_curve;
@@ -269,28 +335,28 @@ Clustering_Result kl_cluster(const curve_number_t num_centers, const curve_size_
         }
     };
 
-    if (Config::verbosity > 0) py::print("KL_CLUST: computing first center");
+    if (options.verbosity > 0) py::print("KL_CLUST: computing first center");
     if (random_start_center) {
         Random::Uniform_Random_Generator<parameter_t> ugen;
         const curve_number_t r =  std::floor(simplifications.size() * ugen.get());
         if (simplifications[r].empty()) {
-            if (Config::verbosity > 0) py::print("KL_CLUST: computing simplification of curve ", r);
+            if (options.verbosity > 0) py::print("KL_CLUST: computing simplification of curve ", r);
             simplifications[r] = simplify(r);
         }
         centers.push_back(r);
     } else {
         if (simplifications[0].empty()) {
-            if (Config::verbosity > 0) py::print("KL_CLUST: computing simplification of curve 0");
+            if (options.verbosity > 0) py::print("KL_CLUST: computing simplification of curve 0");
             simplifications[0] = simplify(0);
             centers.push_back(0);
         }
     }
-    if (Config::verbosity > 0) py::print("KL_CLUST: first center is ", centers[0]);
+    if (options.verbosity > 0) py::print("KL_CLUST: first center is ", centers[0]);
     
     distance_t curr_curve_cost, curr_maxdist = 0;
     curve_number_t curr_maxcurve = 0;
 
-    if (Config::verbosity > 0) py::print("KL_CLUST: computing remaining centers");
+    if (options.verbosity > 0) py::print("KL_CLUST: computing remaining centers");
     {
         // remaining centers
         for (curve_number_t i = 1; i < num_centers; ++i) {
@@ -299,11 +365,11 @@ Clustering_Result kl_cluster(const curve_number_t num_centers, const curve_size_
             curr_maxcurve = 0;
             {
             
-                if (Config::verbosity > 0) py::print("KL_CLUST: computing new center");
+                if (options.verbosity > 0) py::print("KL_CLUST: computing new center");
                 // all curves
                 for (curve_number_t j = 0; j < in.size(); ++j) {
                     
-                    curr_curve_cost = _curve_cost(j, in, simplifications, centers, distances, distance_func);
+                    curr_curve_cost = _curve_cost(j, in, simplifications, centers, distances, &envelopes, distance_func, options);
                     
                     if (curr_curve_cost > curr_maxdist) {
                         curr_maxdist = curr_curve_cost;
@@ -311,11 +377,11 @@ Clustering_Result kl_cluster(const curve_number_t num_centers, const curve_size_
                     }
                     
                 }
-                if (Config::verbosity > 0) py::print("KL_CLUST: center ", i + 1, " is curve ", curr_maxcurve);
-                if (Config::verbosity > 0) py::print("KL_CLUST: current cost is ", curr_maxdist);
+                if (options.verbosity > 0) py::print("KL_CLUST: center ", i + 1, " is curve ", curr_maxcurve);
+                if (options.verbosity > 0) py::print("KL_CLUST: current cost is ", curr_maxdist);
                 
                 if (simplifications[curr_maxcurve].empty()) {
-                    if (Config::verbosity > 0) py::print("KL_CLUST: computing simplification of ", curr_maxcurve);
+                    if (options.verbosity > 0) py::print("KL_CLUST: computing simplification of ", curr_maxcurve);
                     simplifications[curr_maxcurve] = simplify(curr_maxcurve);
                 }
                 centers.push_back(curr_maxcurve);
@@ -323,18 +389,18 @@ Clustering_Result kl_cluster(const curve_number_t num_centers, const curve_size_
         }
     }
     
-    if (Config::verbosity > 0) py::print("KL_CLUST: k-center cost is ", curr_maxdist);
+    if (options.verbosity > 0) py::print("KL_CLUST: k-center cost is ", curr_maxdist);
     
     if (local_search > 0) {
         
         Curve_Numbers curr_centers = centers;
         distance_t cost = curr_maxdist, curr_cost = cost;
         
-        if (Config::verbosity > 0) py::print("KL_CLUST: starting local search for k-center objective for ", local_search, " iterations");
+        if (options.verbosity > 0) py::print("KL_CLUST: starting local search for k-center objective for ", local_search, " iterations");
         
         for (unsigned int k = 0; k < local_search; ++k) {
         
-            if (Config::verbosity > 0) py::print("KL_CLUST: k-center local search iteration ", k + 1);
+            if (options.verbosity > 0) py::print("KL_CLUST: k-center local search iteration ", k + 1);
         
             for (curve_number_t i = 0; i < num_centers; ++i) {
                 
@@ -342,23 +408,23 @@ Clustering_Result kl_cluster(const curve_number_t num_centers, const curve_size_
                     
                     if (std::find(curr_centers.begin(), curr_centers.end(), j) != curr_centers.end()) continue;
                     
-                    if (Config::verbosity > 0) py::print("KL_CLUST: substituting curve ", curr_centers[i]," for curve ", j," as center");
+                    if (options.verbosity > 0) py::print("KL_CLUST: substituting curve ", curr_centers[i]," for curve ", j," as center");
                     // swap
                     if (simplifications[j].empty()) {
-                        if (Config::verbosity > 0) py::print("KL_CLUST: computing simplification of curve ", j);
+                        if (options.verbosity > 0) py::print("KL_CLUST: computing simplification of curve ", j);
                         simplifications[j] = simplify(j);
                     }
                     curr_centers[i] = j;
                     // new cost
-                    if (Config::verbosity > 0) py::print("KL_CLUST: updating k-center cost");
-                    curr_cost = _center_cost_max(in, simplifications, curr_centers, distances, distance_func);
+                    if (options.verbosity > 0) py::print("KL_CLUST: updating k-center cost");
+                    curr_cost = _center_cost_max(in, simplifications, curr_centers, distances, &envelopes, distance_func, options);
                     // check if improvement is done
                     if (curr_cost < cost) {
-                        if (Config::verbosity > 0) py::print("KL_CLUST: cost improves to ", curr_cost);
+                        if (options.verbosity > 0) py::print("KL_CLUST: cost improves to ", curr_cost);
                         cost = curr_cost;
                         centers = curr_centers;
                     } else {
-                        if (Config::verbosity > 0) py::print("KL_CLUST: cost does not improve");
+                        if (options.verbosity > 0) py::print("KL_CLUST: cost does not improve");
                     }
                 }
             }
@@ -368,14 +434,14 @@ Clustering_Result kl_cluster(const curve_number_t num_centers, const curve_size_
     
     if (median) {
         
-        if (Config::verbosity > 0) py::print("KL_CLUST: computing k-median cost");
-        distance_t cost = _center_cost_sum(in, simplifications, centers, distances, distance_func), approxcost = cost, curr_cost = cost;
-        if (Config::verbosity > 0) py::print("KL_CLUST: k-median cost is ", cost);
+        if (options.verbosity > 0) py::print("KL_CLUST: computing k-median cost");
+        distance_t cost = _center_cost_sum(in, simplifications, centers, distances, &envelopes, distance_func, options), approxcost = cost, curr_cost = cost;
+        if (options.verbosity > 0) py::print("KL_CLUST: k-median cost is ", cost);
         distance_t gamma = 1/(10 * num_centers);
         bool found = true;
         Curve_Numbers curr_centers = centers;
         
-        if (Config::verbosity > 0) py::print("KL_CLUST: starting k-median local search");
+        if (options.verbosity > 0) py::print("KL_CLUST: starting k-median local search");
         // try to improve current solution
         while (found) {
             found = false;
@@ -389,24 +455,24 @@ Clustering_Result kl_cluster(const curve_number_t num_centers, const curve_size_
                     // continue if curve is already part of center set
                     if (std::find(curr_centers.begin(), curr_centers.end(), j) != curr_centers.end()) continue;
                                         
-                    if (Config::verbosity > 0) py::print("KL_CLUST: substituting curve ", curr_centers[i]," for curve ", j," as center");
+                    if (options.verbosity > 0) py::print("KL_CLUST: substituting curve ", curr_centers[i]," for curve ", j," as center");
                     // swap
                     if (simplifications[j].empty()) {
-                        if (Config::verbosity > 0) py::print("KL_CLUST: computing simplification of curve ", j);
+                        if (options.verbosity > 0) py::print("KL_CLUST: computing simplification of curve ", j);
                         simplifications[j] = simplify(j);
                     }
                     curr_centers[i] = j;
                     // new cost
-                    if (Config::verbosity > 0) py::print("KL_CLUST: updating k-median cost");
-                    curr_cost = _center_cost_sum(in, simplifications, curr_centers, distances, distance_func);
+                    if (options.verbosity > 0) py::print("KL_CLUST: updating k-median cost");
+                    curr_cost = _center_cost_sum(in, simplifications, curr_centers, distances, &envelopes, distance_func, options);
                     // check if improvement is done
                     if (curr_cost < cost - gamma * approxcost) {
-                        if (Config::verbosity > 0) py::print("KL_CLUST: cost improves to ", curr_cost);
+                        if (options.verbosity > 0) py::print("KL_CLUST: cost improves to ", curr_cost);
                         cost = curr_cost;
                         centers = curr_centers;
                         found = true;
                     } else {
-                        if (Config::verbosity > 0) py::print("KL_CLUST: cost does not improve");
+                        if (options.verbosity > 0) py::print("KL_CLUST: cost does not improve");
                     }
                 }
             }
@@ -426,12 +492,12 @@ Clustering_Result kl_cluster(const curve_number_t num_centers, const curve_size_
     return result;
 }
 
-Clustering_Result kl_center(const curve_number_t num_centers, const curve_size_t ell, const Curves &in, unsigned int local_search, const bool consecutive_call, const bool random_start_center, const bool fast_simplification, const unsigned int distance_func) {
-    return kl_cluster(num_centers, ell, in, local_search, false, consecutive_call, random_start_center, fast_simplification, distance_func);
+Clustering_Result kl_center(const curve_number_t num_centers, const curve_size_t ell, const Curves &in, unsigned int local_search, const bool consecutive_call, const bool random_start_center, const bool fast_simplification, const unsigned int distance_func, const Config::Options &options) {
+    return kl_cluster(num_centers, ell, in, local_search, false, consecutive_call, random_start_center, fast_simplification, distance_func, options);
 }
 
-Clustering_Result kl_median(const curve_number_t num_centers, const curve_size_t ell, const Curves &in, const bool consecutive_call, const bool fast_simplification, const unsigned int distance_func) {
-    return kl_cluster(num_centers, ell, in, 0, true, consecutive_call, true, fast_simplification, distance_func);
+Clustering_Result kl_median(const curve_number_t num_centers, const curve_size_t ell, const Curves &in, const bool consecutive_call, const bool fast_simplification, const unsigned int distance_func, const Config::Options &options) {
+    return kl_cluster(num_centers, ell, in, 0, true, consecutive_call, true, fast_simplification, distance_func, options);
 }
 
 }
@@ -18,5 +18,10 @@ namespace Config {
     int number_threads = -1;
     bool use_distance_matrix = true;
     bool dtw_contingency = false;
+    long dtw_sakoe_chiba_radius = -1;
+    distance_t dtw_itakura_slope = 0;
+    long dtw_approximation_radius = -1;
+    distance_t continuous_frechet_error = 1;
+    bool continuous_frechet_compact = false;
     
 }
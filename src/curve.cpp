@@ -12,8 +12,9 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include "curve.hpp"
 #include "simplification.hpp"
+#include "batch.hpp"
 
-Curve::Curve(const Points &points, const std::string &name) : Points(points), vstart{0}, vend{points.size() - 1}, name{name} {
+Curve::Curve(const Points &points, const std::string &name) : Points(points), name{name} {
     if (points.empty()) { 
         std::cerr << "warning: constructed empty curve" << std::endl;
         return; 
@@ -23,7 +24,7 @@ Curve::Curve(const Points &points, const std::string &name) : Points(points), vs
     #endif
 }
 
-Curve::Curve(const py::array_t<coordinate_t> &in, const std::string &name) : Points(in.request().shape[0], in.request().ndim > 1 ? in.request().shape[1] : 1), name{name}, vstart{0}, vend{Points::size() - 1} {
+Curve::Curve(const py::array_t<coordinate_t> &in, const std::string &name, const bool copy) : Points(in.ndim() > 1 ? in.shape(1) : 1), name{name} {
     const auto array_dim = in.ndim();
     
     if (array_dim > 2){
@@ -32,22 +33,35 @@ Curve::Curve(const py::array_t<coordinate_t> &in, const std::string &name) : Poi
         std::cerr << "WARNING: constructed empty curve" << std::endl;
         return;
     }
-
-    if (array_dim == 2) {        
-        #if DEBUG
-        std::cout << "constructing curve of size " << number() << " and " << dimensions() << " dimensions" << std::endl;
-        #endif
-                
-        #pragma omp parallel for simd collapse(2)
-        for (curve_size_t i = 0; i < number(); ++i) {
-            for(dimensions_t j = 0; j < dimensions(); ++j){
-              Points::operator[](i)[j] = *in.data(i, j);
-            }
-        }
+    
+    const curve_size_t number_points = in.shape(0);
+    const dimensions_t dim = Points::dimensions();
+    
+    #if DEBUG
+    std::cout << "constructing curve of size " << number_points << " and " << dim << " dimensions" << std::endl;
+    #endif
+    
+    if (not copy and (in.flags() & py::array::c_style)) {
+        Points::operator=(Points(in.data(), number_points, dim, share_array(in)));
+    } else if (in.flags() & py::array::c_style) {
+        Points::operator=(Points(number_points, dim));
+        std::copy_n(in.data(), number_points * dim, Points::data());
     } else {
-        #pragma omp parallel for simd
-        for (curve_size_t i = 0; i < number(); ++i) {
-            Points::operator[](i)[0] = *in.data(i);
+        Points::operator=(Points(number_points, dim));
+        coordinate_t *coordinates = Points::data();
+        
+        if (array_dim == 2) {
+            #pragma omp parallel for simd collapse(2)
+            for (curve_size_t i = 0; i < number_points; ++i) {
+                for(dimensions_t j = 0; j < dim; ++j){
+                  coordinates[i * dim + j] = *in.data(i, j);
+                }
+            }
+        } else {
+            #pragma omp parallel for simd
+            for (curve_size_t i = 0; i < number_points; ++i) {
+                coordinates[i] = *in.data(i);
+            }
         }
     }
     
@@ -57,23 +71,148 @@ Curve::Curve(const py::array_t<coordinate_t> &in, const std::string &name) : Poi
     }
 }
 
-Curves Curves::simplify(const curve_size_t l, const bool approx = false) {
-    Curves result(size(), l, Curves::dimensions());
-    for (curve_number_t i = 0; i < size(); ++i) {
-        if (approx) {
-            Curve simplified_curve = Frechet::Continuous::Simplification::approximate_minimum_error_simplification(std::vector<Curve>::operator[](i), l);
-            simplified_curve.set_name("Simplification of " + std::vector<Curve>::operator[](i).get_name());
-            result[i] = simplified_curve;
+Curves::Curves(const py::array_t<coordinate_t> &in, const bool copy) : m{0}, dim{0} {
+    if (in.ndim() != 3) {
+        std::cerr << "Curves of equal complexity require a 3-dimensional numpy array of type " << typeid(coordinate_t).name() << "." << std::endl;
+        std::cerr << "Current dimensions: " << in.ndim() << std::endl;
+        std::cerr << "WARNING: constructed empty collection of curves" << std::endl;
+        return;
+    }
+    
+    const curve_number_t n = in.shape(0);
+    const curve_size_t complexity = in.shape(1);
+    
+    std::vector<curve_size_t> offsets(n + 1);
+    for (curve_number_t i = 0; i <= n; ++i) {
+        offsets[i] = i * complexity;
+    }
+    
+    if (not copy and (in.flags() & py::array::c_style)) {
+        const Points points(in.data(), n * complexity, in.shape(2), share_array(in));
+        py::gil_scoped_release release;
+        assign_slices(points, offsets);
+    } else {
+        const auto values = in.unchecked<3>();
+        Points points(n * complexity, in.shape(2));
+        coordinate_t *coordinates = points.data();
+        const dimensions_t dim = points.dimensions();
+        py::gil_scoped_release release;
+        
+        #pragma omp parallel for collapse(2)
+        for (curve_number_t i = 0; i < n; ++i) {
+            for (curve_size_t j = 0; j < complexity; ++j) {
+                for (dimensions_t k = 0; k < dim; ++k) {
+                    coordinates[(i * complexity + j) * dim + k] = values(i, j, k);
+                }
+            }
+        }
+        assign_slices(points, offsets);
+    }
+}
+
+Curves::Curves(const py::array_t<coordinate_t> &in, const py::array_t<curve_size_t> &in_offsets, const bool copy) : m{0}, dim{0} {
+    if (in.ndim() > 2 or in_offsets.ndim() != 1) {
+        std::cerr << "Curves require a 1- or 2-dimensional numpy array of type " << typeid(coordinate_t).name() << " and a 1-dimensional array of offsets." << std::endl;
+        std::cerr << "WARNING: constructed empty collection of curves" << std::endl;
+        return;
+    }
+    
+    const curve_size_t number_points = in.shape(0);
+    const dimensions_t in_dim = in.ndim() > 1 ? in.shape(1) : 1;
+    const auto offsets_values = in_offsets.unchecked<1>();
+    std::vector<curve_size_t> offsets(offsets_values.shape(0));
+    
+    for (curve_number_t i = 0; i < offsets.size(); ++i) {
+        offsets[i] = offsets_values(i);
+        if ((i > 0 and offsets[i] < offsets[i - 1]) or offsets[i] > number_points) {
+            std::cerr << "Offsets must be non-decreasing and at most the number of points (" << number_points << ")." << std::endl;
+            std::cerr << "WARNING: constructed empty collection of curves" << std::endl;
+            return;
+        }
+    }
+    
+    if (not copy and (in.flags() & py::array::c_style)) {
+        const Points points(in.data(), number_points, in_dim, share_array(in));
+        py::gil_scoped_release release;
+        assign_slices(points, offsets);
+    } else {
+        Points points(number_points, in_dim);
+        coordinate_t *coordinates = points.data();
+        
+        if (in.flags() & py::array::c_style) {
+            std::copy_n(in.data(), number_points * in_dim, coordinates);
+        } else if (in.ndim() == 2) {
+            const auto values = in.unchecked<2>();
+            #pragma omp parallel for collapse(2)
+            for (curve_size_t i = 0; i < number_points; ++i) {
+                for (dimensions_t j = 0; j < in_dim; ++j) {
+                    coordinates[i * in_dim + j] = values(i, j);
+                }
+            }
         } else {
-            Frechet::Continuous::Simplification::Subcurve_Shortcut_Graph graph(std::vector<Curve>::operator[](i));
-            Curve simplified_curve = graph.minimum_error_simplification(l);
-            simplified_curve.set_name("Simplification of " + std::vector<Curve>::operator[](i).get_name());
-            result[i] = simplified_curve;
+            const auto values = in.unchecked<1>();
+            #pragma omp parallel for
+            for (curve_size_t i = 0; i < number_points; ++i) {
+                coordinates[i] = values(i);
+            }
+        }
+        py::gil_scoped_release release;
+        assign_slices(points, offsets);
+    }
+}
+
+Curves::Curves(const Points &points, const std::vector<curve_size_t> &offsets) : m{0}, dim{0} {
+    assign_slices(points, offsets);
+}
+
+void Curves::assign_slices(const Points &points, const std::vector<curve_size_t> &offsets) {
+    const curve_number_t n = offsets.empty() ? 0 : offsets.size() - 1;
+    
+    dim = points.dimensions();
+    assign(n, Curve(dim));
+    
+    // all curves share the buffer of points
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (curve_number_t i = 0; i < n; ++i) {
+        if (offsets[i + 1] > offsets[i]) {
+            operator[](i) = Curve(Points(points, offsets[i], offsets[i + 1] - offsets[i]));
+        }
+    }
+    
+    for (curve_number_t i = 0; i < n; ++i) {
+        m = std::max(m, offsets[i + 1] - offsets[i]);
+    }
+}
+
+py::object Curves::as_ndarray() const {
+    if (empty()) return py::array_t<coordinate_t>(0);
+    
+    const curve_size_t complexity = front().complexity();
+    const dimensions_t dim = front().dimensions();
+    
+    for (const Curve &curve : *this) {
+        if (curve.complexity() != complexity) {
+            // ragged collection, one array per curve
+            py::list l;
+            for (const Curve &elem : *this) {
+                l.append(elem.as_ndarray());
+            }
+            return l;
         }
-        #if DEBUG
-        std::cout << "Simplified curve " << i + 1 << "/" << size() << "." << std::endl;
-        #endif
     }
+    
+    py::array_t<coordinate_t> result({size(), complexity, dim});
+    coordinate_t *values = result.mutable_data();
+    
+    for (curve_number_t i = 0; i < size(); ++i) {
+        std::copy_n(operator[](i).data(), complexity * dim, values + i * complexity * dim);
+    }
+    return result;
+}
+
+Curves Curves::simplify(const curve_size_t l, const bool approx = false, const Config::Options &options) {
+    Curves result(size(), l, Curves::dimensions());
+    Batch::_simplify(*this, result, l, approx, options);
     return result;
 }
 
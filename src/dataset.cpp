@@ -0,0 +1,163 @@
+/*
+Copyright 2020-2021 Dennis Rohde
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <fstream>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "dataset.hpp"
+
+namespace Dataset {
+    
+static const char magic[8] = "FREDCRV";
+static const std::uint64_t version = 1;
+
+#ifdef _WIN32
+
+// no mmap, the file is read into memory instead
+static std::shared_ptr<const char> map(const std::string &path, std::size_t &length) {
+    std::ifstream file(path, std::ios::binary);
+    if (not file) throw std::runtime_error("cannot open " + path);
+    auto buffer = std::make_shared<std::vector<char>>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    length = buffer->size();
+    return std::shared_ptr<const char>(buffer, buffer->data());
+}
+
+#else
+
+static std::shared_ptr<const char> map(const std::string &path, std::size_t &length) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("cannot open " + path);
+    
+    struct stat status;
+    if (::fstat(fd, &status) != 0) {
+        ::close(fd);
+        throw std::runtime_error("cannot stat " + path);
+    }
+    length = status.st_size;
+    if (length == 0) {
+        ::close(fd);
+        throw std::runtime_error(path + " is empty");
+    }
+    
+    void *address = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) throw std::runtime_error("cannot map " + path);
+    
+    return std::shared_ptr<const char>(static_cast<const char*>(address), [length](const char *address) { 
+        ::munmap(const_cast<char*>(address), length); 
+    });
+}
+
+#endif
+
+void save(const Curves &curves, const std::string &path, const bool names) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (not file) throw std::runtime_error("cannot open " + path + " for writing");
+    
+    std::vector<std::uint64_t> offsets(curves.size() + 1, 0);
+    for (curve_number_t i = 0; i < curves.size(); ++i) {
+        offsets[i + 1] = offsets[i] + curves[i].complexity();
+    }
+    
+    std::string names_blob;
+    if (names) {
+        for (const Curve &curve : curves) {
+            names_blob += curve.get_name();
+            names_blob.push_back('\0');
+        }
+    }
+    
+    Header header;
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.number_curves = curves.size();
+    header.dimensions = curves.dimensions();
+    header.number_points = offsets.back();
+    header.names_size = names_blob.size();
+    
+    file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    file.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(std::uint64_t));
+    
+    for (const Curve &curve : curves) {
+        if (curve.empty()) continue;
+        if (curve.dimensions() != header.dimensions) throw std::runtime_error("curves of different dimensions cannot be saved together");
+        file.write(reinterpret_cast<const char*>(curve.data()), curve.complexity() * curve.dimensions() * sizeof(coordinate_t));
+    }
+    
+    file.write(names_blob.data(), names_blob.size());
+    if (not file) throw std::runtime_error("cannot write " + path);
+}
+
+Curves load(const std::string &path) {
+    std::size_t length;
+    const auto file = map(path, length);
+    
+    Header header;
+    if (length < sizeof(Header)) throw std::runtime_error(path + " is not a curve file");
+    std::memcpy(&header, file.get(), sizeof(Header));
+    
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0) throw std::runtime_error(path + " is not a curve file");
+    if (header.version != version) throw std::runtime_error(path + " has unsupported version " + std::to_string(header.version));
+    
+    // the sizes are checked one by one, so that the positions computed from them cannot overflow
+    const std::size_t available = length - sizeof(Header);
+    if (header.number_curves >= available / sizeof(std::uint64_t)) throw std::runtime_error(path + " is truncated or corrupt");
+    if (header.dimensions > 0 and header.number_points > available / sizeof(coordinate_t) / header.dimensions) throw std::runtime_error(path + " is truncated or corrupt");
+    if (header.names_size > available) throw std::runtime_error(path + " is truncated or corrupt");
+    
+    const std::size_t offsets_position = sizeof(Header);
+    const std::size_t coordinates_position = offsets_position + (header.number_curves + 1) * sizeof(std::uint64_t);
+    const std::size_t names_position = coordinates_position + header.number_points * header.dimensions * sizeof(coordinate_t);
+    
+    if (names_position + header.names_size != length) throw std::runtime_error(path + " is truncated or corrupt");
+    
+    const auto *file_offsets = reinterpret_cast<const std::uint64_t*>(file.get() + offsets_position);
+    std::vector<curve_size_t> offsets(file_offsets, file_offsets + header.number_curves + 1);
+    
+    if (offsets.front() != 0 or offsets.back() != header.number_points) throw std::runtime_error(path + " has invalid offsets");
+    for (curve_number_t i = 1; i < offsets.size(); ++i) {
+        if (offsets[i] < offsets[i - 1]) throw std::runtime_error(path + " has invalid offsets");
+    }
+    
+    // one name per curve, each terminated by a null character
+    const char *names = file.get() + names_position;
+    if (header.names_size > 0 and (names[header.names_size - 1] != '\0' or static_cast<std::uint64_t>(std::count(names, names + header.names_size, '\0')) < header.number_curves)) {
+        throw std::runtime_error(path + " has invalid names");
+    }
+    
+    const Points points(reinterpret_cast<const coordinate_t*>(file.get() + coordinates_position), header.number_points, header.dimensions, file);
+    Curves result(points, offsets);
+    
+    if (header.names_size > 0) {
+        const char *name = names;
+        for (curve_number_t i = 0; i < result.size(); ++i) {
+            const std::size_t name_length = std::strlen(name);
+            result[i].set_name(std::string(name, name_length));
+            name += name_length + 1;
+        }
+    }
+    
+    return result;
+}
+
+}
@@ -9,8 +9,11 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 */
 
 #include <vector>
+#include <deque>
 #include <limits>
 #include <chrono>
+#include <memory>
+#include <cstdint>
 
 #include "dynamic_time_warping.hpp"
 
@@ -24,15 +27,15 @@ std::string Distance::repr() const {
     return ss.str();
 }
     
-Points vertices_matching_points(const Curve &input_curve, const Curve &center_curve, const Distance &dist) {
+Points vertices_matching_points(const Curve &input_curve, const Curve &center_curve, const Distance &dist, const Config::Options &options) {
     if ((input_curve.complexity() < 2) or (center_curve.complexity() < 2)) {
         py::print("WARNING: curves must be of at least two points");
         Points result(center_curve.dimensions());
         return result;
     }
         
-    if (Config::verbosity > 1) py::print("DDTW: computing matching points from center_curve of complexity ", center_curve.complexity(), " to input_curve of complexity ", input_curve.complexity());
-    if (Config::verbosity > 2) py::print("DDTW: distance between input_curve and center_curve is ", dist.value);
+    if (options.verbosity > 1) py::print("DDTW: computing matching points from center_curve of complexity ", center_curve.complexity(), " to input_curve of complexity ", input_curve.complexity());
+    if (options.verbosity > 2) py::print("DDTW: distance between input_curve and center_curve is ", dist.value);
     
     std::vector<Points> matching_points(center_curve.size(), Points(center_curve.dimensions()));    
     
@@ -42,25 +45,106 @@ Points vertices_matching_points(const Curve &input_curve, const Curve &center_cu
         j = dist.matching[i].first;
         k = dist.matching[i].second;
         
-        if (Config::verbosity > 2) py::print("DDTW: matching point ", j, " on input_curve to point ", k, " on curve 2");
+        if (options.verbosity > 2) py::print("DDTW: matching point ", j, " on input_curve to point ", k, " on curve 2");
         matching_points[k].push_back(input_curve[j]);
     }
     
     Points result(center_curve.size(), center_curve.dimensions());
     
-    if (Config::verbosity > 2) py::print("DDTW: computing centroids to aggregate multi-matching points");
+    if (options.verbosity > 2) py::print("DDTW: computing centroids to aggregate multi-matching points");
     
     for (curve_size_t i = 0; i < center_curve.size(); ++i) {
-        if (Config::verbosity > 2) py::print("DDTW: computing centroid ", i);
+        if (options.verbosity > 2) py::print("DDTW: computing centroid ", i);
         result[i] = matching_points[i].centroid();
     }
 
-    if (Config::verbosity > 2) py::print("DDTW: matching points computed");
+    if (options.verbosity > 2) py::print("DDTW: matching points computed");
         
     return result;
 }
     
-Distance distance(const Curve &curve1, const Curve &curve2) {
+/*
+ * Widens the windows where necessary to overlap, so the last cell stays reachable from the first.
+ */
+static void _connect(const curve_size_t n2, std::vector<curve_size_t> &first, std::vector<curve_size_t> &last) {
+    const curve_size_t n1 = first.size();
+    first[0] = 0;
+    last[n1 - 1] = n2 - 1;
+    for (curve_size_t i = 1; i < n1; ++i) {
+        first[i] = std::min(first[i], last[i - 1] + 1);
+        last[i] = std::max(last[i], first[i]);
+    }
+}
+
+static inline bool _banded(const Config::Options &options) {
+    return options.dtw_sakoe_chiba_radius >= 0 or options.dtw_itakura_slope > 1;
+}
+
+/*
+ * Window of columns first[i] to last[i] of curve2 that vertex i of curve1 may be matched to: the intersection of
+ * a Sakoe-Chiba band of the given radius around the diagonal, widened by the difference in complexity, and an Itakura parallelogram
+ * of the given maximum slope, connected as above.
+ */
+static void _window(const curve_size_t n1, const curve_size_t n2, const Config::Options &options, std::vector<curve_size_t> &first, std::vector<curve_size_t> &last) {
+    first.assign(n1, 0);
+    last.assign(n1, n2 - 1);
+    
+    if (options.dtw_sakoe_chiba_radius >= 0) {
+        const long radius = options.dtw_sakoe_chiba_radius;
+        const long below = n1 > n2 ? n1 - n2 : 0, above = n2 > n1 ? n2 - n1 : 0;
+        for (curve_size_t i = 0; i < n1; ++i) {
+            first[i] = std::max(0l, static_cast<long>(i) - below - radius);
+            last[i] = std::min(static_cast<long>(n2) - 1, static_cast<long>(i) + above + radius);
+        }
+    }
+    
+    if (options.dtw_itakura_slope > 1) {
+        const distance_t slope = options.dtw_itakura_slope;
+        for (curve_size_t i = 0; i < n1; ++i) {
+            const distance_t x = distance_t(i) / (n1 - 1);
+            const distance_t low = std::max(x / slope, 1 - slope * (1 - x)), high = std::min(slope * x, 1 - (1 - x) / slope);
+            first[i] = std::max(first[i], static_cast<curve_size_t>(std::max(distance_t(0), std::ceil(low * (n2 - 1)))));
+            last[i] = std::min(last[i], static_cast<curve_size_t>(std::max(distance_t(0), std::floor(high * (n2 - 1)))));
+        }
+    }
+    
+    _connect(n2, first, last);
+}
+
+/*
+ * Steps of the warping path in the columns first[i] to last[i] of each row, packed into two bits per cell.
+ */
+class Direction_Table {
+    const std::vector<curve_size_t> &first;
+    std::vector<std::size_t> offset;
+    std::vector<std::uint8_t> cells;
+    
+public:
+    static constexpr std::uint8_t diagonal = 0, left = 1, up = 2;
+    
+    Direction_Table(const std::vector<curve_size_t> &first, const std::vector<curve_size_t> &last) : first{first}, offset(first.size() + 1, 0) {
+        for (curve_size_t i = 0; i < first.size(); ++i) offset[i + 1] = offset[i] + last[i] - first[i] + 1;
+        cells.assign((offset.back() + 3) / 4, 0);
+    }
+    
+    inline void set(const curve_size_t i, const curve_size_t j, const std::uint8_t direction) {
+        const std::size_t index = offset[i] + j - first[i];
+        cells[index / 4] |= direction << (2 * (index % 4));
+    }
+    
+    inline std::uint8_t get(const curve_size_t i, const curve_size_t j) const {
+        const std::size_t index = offset[i] + j - first[i];
+        return (cells[index / 4] >> (2 * (index % 4))) & 3;
+    }
+};
+
+/*
+ * The dynamic program within the windows of columns of every row keeps two rows of costs and, with contingency, of multi-warp counters,
+ * each stored from the first column of its window on; only the directions are kept for all cells, and only if the matching is requested.
+ * Without windows, every row spans all columns and no bounds are kept per row.
+ */
+template<dimensions_t D>
+Distance _distance(const Curve &curve1, const Curve &curve2, const std::vector<curve_size_t> &window_first, const std::vector<curve_size_t> &window_last, const distance_t cutoff, const Config::Options &options, const bool with_matching) {
     Distance result;
     
     if ((curve1.complexity() < 2) or (curve2.complexity() < 2)) {
@@ -77,76 +161,314 @@ Distance distance(const Curve &curve1, const Curve &curve2) {
         
     if (n1 < n2) contingency1 += n2 - n1 + 1;
     if (n2 < n1) contingency2 += n1 - n2 + 1;
-
-    std::vector<std::vector<std::pair<curve_number_t, curve_number_t>>> multi_warp_counter(n1 + 1, std::vector<std::pair<curve_number_t, curve_number_t>>(n2 + 1, std::make_pair(0, 0)));
-    std::vector<std::vector<std::pair<curve_number_t, curve_number_t>>> b(n1 + 1, std::vector<std::pair<curve_number_t, curve_number_t>>(n2 + 1, std::make_pair(0, 0)));
-    std::vector<std::vector<distance_t>> a(n1 + 1, std::vector<distance_t>(n2 + 1, infty));
-    std::vector<std::vector<distance_t>> dists(n1, std::vector<distance_t>(n2));
     
-    #pragma omp parallel for collapse(2)
-    for (curve_size_t i = 0; i < n1; ++i) {
-        for (curve_size_t j = 0; j < n2; ++j) {
-            dists[i][j] = curve1[i].dist(curve2[j]);
+    // row i and column j of the tables belong to vertex i - 1 of curve1 and vertex j - 1 of curve2, row 0 holds the origin only
+    const bool windowed = not window_first.empty();
+    const auto row_first = [&](const curve_size_t i) -> curve_size_t {
+        return i == 0 ? 0 : windowed ? window_first[i - 1] + 1 : 1;
+    };
+    const auto row_last = [&](const curve_size_t i) -> curve_size_t {
+        return i == 0 ? 0 : windowed ? window_last[i - 1] + 1 : n2;
+    };
+    
+    curve_size_t width = windowed ? 1 : n2;
+    for (curve_size_t i = 0; windowed and i < n1; ++i) width = std::max(width, window_last[i] - window_first[i] + 1);
+    
+    std::vector<curve_size_t> first, last;
+    std::unique_ptr<Direction_Table> directions;
+    if (with_matching) {
+        first.resize(n1 + 1);
+        last.resize(n1 + 1);
+        for (curve_size_t i = 0; i <= n1; ++i) {
+            first[i] = row_first(i);
+            last[i] = row_last(i);
         }
+        directions = std::make_unique<Direction_Table>(first, last);
     }
     
-    unsigned int mwd = 0;
+    // column j of row i is stored at j - row_first(i), columns outside the window are infinite
+    std::vector<distance_t> a_prev(width, infty), a_cur(width, infty);
+    std::vector<std::pair<curve_number_t, curve_number_t>> counter_prev, counter_cur;
+    if (options.dtw_contingency) {
+        counter_prev.assign(width, std::make_pair(0, 0));
+        counter_cur.assign(width, std::make_pair(0, 0));
+    }
     
-    curve_number_t ii = 1, jj = 1;
+    std::uint8_t direction;
     distance_t min_ele;
     
-    a[0][0] = 0;
+    a_prev[0] = 0;
     for (curve_size_t i = 1; i <= n1; ++i) {
-        for (curve_size_t j = 1; j <= n2; ++j) {
-            a[i][j] = dists[i-1][j-1];
-            mwd = 0;
+        const curve_size_t prev_first = row_first(i - 1), prev_last = row_last(i - 1), cur_first = row_first(i), cur_last = row_last(i);
+        const auto previous = [&](const curve_size_t j) {
+            return j >= prev_first and j <= prev_last ? a_prev[j - prev_first] : infty;
+        };
+        
+        // costs only grow along a warping path, which passes every row
+        distance_t row_min = infty;
+        
+        for (curve_size_t j = cur_first; j <= cur_last; ++j) {
+            distance_t cost = curve1[i-1].dist<D>(curve2[j-1]);
+            const distance_t diagonal = previous(j - 1), up = previous(j), left = j > cur_first ? a_cur[j - 1 - cur_first] : infty;
             
-            ii = i - 1, jj = j - 1;
-            min_ele = a[i - 1][j - 1];
+            direction = Direction_Table::diagonal;
+            min_ele = diagonal;
             
-            if (a[i][j - 1] < min_ele) {
-                if ((Config::dtw_contingency and multi_warp_counter[i][j - 1].first < contingency1) or not Config::dtw_contingency) {
-                    min_ele = a[i][j - 1];
-                    ii = i;
-                    jj = j - 1;
-                    mwd = 1;
+            if (left < min_ele) {
+                if (not options.dtw_contingency or counter_cur[j - 1 - cur_first].first < contingency1) {
+                    min_ele = left;
+                    direction = Direction_Table::left;
                 }
             }
             
-            if (a[i - 1][j] < min_ele) {
-                if ((Config::dtw_contingency and multi_warp_counter[i - 1][j].second < contingency2) or not Config::dtw_contingency) {
-                    min_ele = a[i - 1][j];
-                    ii = i - 1;
-                    jj = j;
-                    mwd = 2;
+            if (up < min_ele) {
+                if (not options.dtw_contingency or counter_prev[j - prev_first].second < contingency2) {
+                    min_ele = up;
+                    direction = Direction_Table::up;
                 }
             }
             
-            multi_warp_counter[i][j] = multi_warp_counter[ii][jj];
-            if (mwd == 1) ++multi_warp_counter[i][j].first;
-            else if (mwd == 2) ++multi_warp_counter[i][j].second;
+            if (options.dtw_contingency) {
+                auto &counter = counter_cur[j - cur_first];
+                switch (direction) {
+                    case Direction_Table::diagonal:
+                        counter = diagonal < infty ? counter_prev[j - 1 - prev_first] : std::pair<curve_number_t, curve_number_t>(0, 0);
+                        break;
+                    case Direction_Table::left:
+                        counter = counter_cur[j - 1 - cur_first];
+                        ++counter.first;
+                        break;
+                    default:
+                        counter = counter_prev[j - prev_first];
+                        ++counter.second;
+                        break;
+                }
+            }
             
-            a[i][j] += min_ele;
-            b[i][j] = std::make_pair(ii, jj);
+            cost += min_ele;
+            a_cur[j - cur_first] = cost;
+            if (with_matching) directions->set(i, j, direction);
+            row_min = std::min(row_min, cost);
+        }
+        
+        if (row_min > cutoff) {
+            if (options.verbosity > 2) py::print("DDTW: distance exceeds cutoff ", cutoff, " in row ", i);
+            result.n = n1;
+            result.m = n2;
+            result.value = infty;
+            return result;
         }
+        
+        std::swap(a_prev, a_cur);
+        if (options.dtw_contingency) std::swap(counter_prev, counter_cur);
     }
-            
-    for (curve_number_t i = n1, j = n2; ; i = b[i][j].first, j = b[i][j].second) {
-        result.matching.push_back(std::make_pair(i - 1, j - 1));
-        if (b[i][j].first == 1 and b[i][j].second == 1) break;
+    
+    // with contingency, no path may be left within a band
+    if (with_matching and a_prev[n2 - row_first(n1)] < infty) {
+        curve_size_t i = n1, j = n2;
+        while (i > 1 or j > 1) {
+            result.matching.push_back(std::make_pair(i - 1, j - 1));
+            switch (directions->get(i, j)) {
+                case Direction_Table::diagonal:
+                    --i;
+                    --j;
+                    break;
+                case Direction_Table::left:
+                    --j;
+                    break;
+                default:
+                    --i;
+                    break;
+            }
+        }
+        result.matching.push_back(std::make_pair(0, 0));
     }
     
-    result.matching.push_back(std::make_pair(0, 0));
     result.n = n1;
     result.m = n2;
     
     const auto end = std::clock();
     result.time = (end - start) / CLOCKS_PER_SEC;
-    result.value = a[n1][n2];
+    result.value = a_prev[n2 - row_first(n1)];
         
     return result;
 }
 
+template<dimensions_t D>
+Distance _distance(const Curve &curve1, const Curve &curve2, const distance_t cutoff, const Config::Options &options, const bool with_matching) {
+    if ((curve1.complexity() < 2) or (curve2.complexity() < 2)) {
+        py::print("WARNING: curves must be of at least two points");
+        return Distance();
+    }
+    
+    // without a band, the rows need no windows
+    std::vector<curve_size_t> first, last;
+    if (_banded(options)) _window(curve1.complexity(), curve2.complexity(), options, first, last);
+    return _distance<D>(curve1, curve2, first, last, cutoff, options, with_matching);
+}
+
+/*
+ * Halves the complexity by averaging pairs of consecutive vertices; with odd complexity, the last vertex is kept.
+ */
+static Curve _coarsen(const Curve &curve) {
+    const curve_size_t n = curve.complexity(), m = (n + 1) / 2;
+    const dimensions_t dimensions = curve.dimensions();
+    Curve result(m, dimensions);
+    
+    for (curve_size_t i = 0; i < m; ++i) {
+        const curve_size_t j = std::min(2 * i + 1, n - 1);
+        for (dimensions_t k = 0; k < dimensions; ++k) result[i][k] = (curve[2 * i][k] + curve[j][k]) / 2;
+    }
+    
+    return result;
+}
+
+/*
+ * FastDTW: the warping path of the coarsened curves is projected onto the curves and widened by the radius, and the dynamic program
+ * runs only within this window; the recursion ends once a curve is not longer than the radius plus two.
+ */
+template<dimensions_t D>
+Distance _approximate_distance(const Curve &curve1, const Curve &curve2, const distance_t cutoff, const Config::Options &options, const bool with_matching) {
+    const curve_size_t n1 = curve1.complexity(), n2 = curve2.complexity();
+    const curve_size_t radius = options.dtw_approximation_radius;
+    
+    if (n1 <= radius + 2 or n2 <= radius + 2) return _distance<D>(curve1, curve2, cutoff, options, with_matching);
+    
+    const auto coarse = _approximate_distance<D>(_coarsen(curve1), _coarsen(curve2), std::numeric_limits<distance_t>::infinity(), options, true);
+    
+    if (options.verbosity > 2) py::print("DDTW: refining warping path of length ", coarse.matching.size(), " for complexities ", n1, " and ", n2);
+    
+    // the path is monotone, so the projected windows are as well
+    std::vector<curve_size_t> path_first(n1, n2), path_last(n1, 0);
+    for (const auto &cell : coarse.matching) {
+        for (curve_size_t i = 2 * cell.first; i <= std::min(2 * cell.first + 1, n1 - 1); ++i) {
+            path_first[i] = std::min(path_first[i], 2 * cell.second);
+            path_last[i] = std::min(std::max(path_last[i], 2 * cell.second + 1), n2 - 1);
+        }
+    }
+    
+    // the windows stay within the band: where the widened path misses it, they are clamped to its nearer end
+    std::vector<curve_size_t> band_first, band_last, first(n1), last(n1);
+    _window(n1, n2, options, band_first, band_last);
+    for (curve_size_t i = 0; i < n1; ++i) {
+        const curve_size_t below = path_first[i >= radius ? i - radius : 0], above = path_last[std::min(i + radius, n1 - 1)];
+        first[i] = std::max(band_first[i], below >= radius ? below - radius : 0);
+        last[i] = std::min(band_last[i], std::min(above + radius, n2 - 1));
+        if (last[i] < first[i]) {
+            if (first[i] > band_last[i]) first[i] = last[i];
+            else last[i] = first[i];
+        }
+    }
+    
+    // both ends of the windows are monotone, and the band is connected, so gaps are closed by widening the windows within the band
+    first[0] = 0;
+    last[n1 - 1] = n2 - 1;
+    for (curve_size_t i = 1; i < n1; ++i) {
+        if (first[i] > last[i - 1] + 1) {
+            first[i] = std::max(band_first[i], last[i - 1] + 1);
+            last[i - 1] = std::max(last[i - 1], first[i] - 1);
+        }
+    }
+    
+    return _distance<D>(curve1, curve2, first, last, cutoff, options, with_matching);
+}
+
+Distance distance(const Curve &curve1, const Curve &curve2, const distance_t cutoff, const Config::Options &options, const bool with_matching) {
+    if (options.dtw_approximation_radius >= 0) {
+        // contingency could leave no path within the narrow windows
+        Config::Options approximation_options = options;
+        approximation_options.dtw_contingency = false;
+        switch (curve1.dimensions()) {
+            case 1:
+                return _approximate_distance<1>(curve1, curve2, cutoff, approximation_options, with_matching);
+            case 2:
+                return _approximate_distance<2>(curve1, curve2, cutoff, approximation_options, with_matching);
+            case 3:
+                return _approximate_distance<3>(curve1, curve2, cutoff, approximation_options, with_matching);
+            default:
+                return _approximate_distance<0>(curve1, curve2, cutoff, approximation_options, with_matching);
+        }
+    }
+    
+    // without matching, rows run along the shorter curve; this is only symmetric without contingency and bands
+    if (not with_matching and curve2.complexity() > curve1.complexity() and not options.dtw_contingency and not _banded(options)) {
+        auto result = distance(curve2, curve1, cutoff, options, false);
+        std::swap(result.n, result.m);
+        return result;
+    }
+    
+    switch (curve1.dimensions()) {
+        case 1:
+            return _distance<1>(curve1, curve2, cutoff, options, with_matching);
+        case 2:
+            return _distance<2>(curve1, curve2, cutoff, options, with_matching);
+        case 3:
+            return _distance<3>(curve1, curve2, cutoff, options, with_matching);
+        default:
+            return _distance<0>(curve1, curve2, cutoff, options, with_matching);
+    }
+}
+
+Envelope envelope(const Curve &curve2, const curve_size_t n1, const Config::Options &options) {
+    const curve_size_t n2 = curve2.complexity();
+    const dimensions_t dimensions = curve2.dimensions();
+    Envelope result;
+    result.complexity = n1;
+    result.sakoe_chiba_radius = options.dtw_sakoe_chiba_radius;
+    result.itakura_slope = options.dtw_itakura_slope;
+    result.lower = Points(n1, dimensions);
+    result.upper = Points(n1, dimensions);
+    
+    if (n1 < 2 or n2 < 2) return result;
+    
+    std::vector<curve_size_t> first, last;
+    _window(n1, n2, options, first, last);
+    
+    // both ends of the windows only move forward, so the extrema of every coordinate are kept in monotone queues
+    std::deque<curve_size_t> minima, maxima;
+    for (dimensions_t k = 0; k < dimensions; ++k) {
+        minima.clear();
+        maxima.clear();
+        curve_size_t next = 0;
+        for (curve_size_t i = 0; i < n1; ++i) {
+            for (; next <= last[i]; ++next) {
+                while (not minima.empty() and curve2[minima.back()][k] >= curve2[next][k]) minima.pop_back();
+                minima.push_back(next);
+                while (not maxima.empty() and curve2[maxima.back()][k] <= curve2[next][k]) maxima.pop_back();
+                maxima.push_back(next);
+            }
+            while (minima.front() < first[i]) minima.pop_front();
+            while (maxima.front() < first[i]) maxima.pop_front();
+            result.lower[i][k] = curve2[minima.front()][k];
+            result.upper[i][k] = curve2[maxima.front()][k];
+        }
+    }
+    
+    return result;
+}
+
+distance_t lower_bound_kim(const Curve &curve1, const Curve &curve2) {
+    return curve1.front().dist(curve2.front()) + curve1.back().dist(curve2.back());
+}
+
+distance_t lower_bound_keogh(const Curve &curve1, const Envelope &envelope, const distance_t cutoff) {
+    const dimensions_t dimensions = curve1.dimensions();
+    distance_t result = 0;
+    
+    for (curve_size_t i = 0; i < curve1.complexity(); ++i) {
+        distance_t dist_sqr = 0;
+        for (dimensions_t k = 0; k < dimensions; ++k) {
+            const coordinate_t x = curve1[i][k];
+            const distance_t outside = std::max(std::max(envelope.lower[i][k] - x, x - envelope.upper[i][k]), coordinate_t(0));
+            dist_sqr += outside * outside;
+        }
+        result += std::sqrt(dist_sqr);
+        if (result > cutoff) break;
+    }
+    
+    return result;
+}
+
 } // end namespace Discrete
 
 } // end namespace Dynamic Time Warping
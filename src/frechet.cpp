@@ -11,14 +11,16 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vector>
 #include <limits>
 #include <ctime>
+#include <algorithm>
+#include <cmath>
 
 #include "frechet.hpp"
+#include "random.hpp"
 
 namespace Frechet {
 
 namespace Continuous {
     
-distance_t error = 1;
 bool round = true;
     
 std::string Distance::repr() const {
@@ -27,49 +29,72 @@ std::string Distance::repr() const {
     return ss.str();
 }
 
-Points vertices_matching_points(const Curve &input_curve, const Curve &center_curve, const Distance &dist) {
+/*
+ * Free intervals of one row, computed in blocks when the first cell of a block is needed.
+ * Cells have to be requested in increasing order.
+ */
+template<dimensions_t D, bool vertex_row, class I = Interval>
+class Lazy_Free_Intervals {
+    static constexpr curve_size_t block = 32;
+    const distance_t dist_sqr;
+    const Curve &curve1, &curve2;
+    const curve_size_t i, count;
+    curve_size_t first = 0, last = 0;
+    I intervals[block];
+    
+public:
+    // vertex_row: vertex i of curve1 with the segments of curve2, otherwise segment i of curve1 with the vertices of curve2
+    Lazy_Free_Intervals(const distance_t dist_sqr, const Curve &curve1, const Curve &curve2, const curve_size_t i) : 
+        dist_sqr{dist_sqr}, curve1{curve1}, curve2{curve2}, i{i}, count{vertex_row ? curve2.complexity() - 1 : curve2.complexity()} {}
+    
+    inline const I& operator[](const curve_size_t j) {
+        if (j >= last) {
+            first = j;
+            last = std::min(j + block, count);
+            if (vertex_row) ball_intersection_intervals<D>(dist_sqr, curve1[i], curve2[first].data(), last - first, intervals);
+            else ball_intersection_intervals<D>(dist_sqr, curve1[i], curve1[i+1], curve2[first].data(), last - first, intervals);
+        }
+        return intervals[j - first];
+    }
+};
+
+Points vertices_matching_points(const Curve &input_curve, const Curve &center_curve, const Distance &dist, const Config::Options &options) {
     if ((center_curve.complexity() < 2) or (input_curve.complexity() < 2)) {
         py::print("WARNING: curves must be of at least two points");
         Points result(center_curve.dimensions());
         return result;
     }
     
-    if (Config::verbosity > 1) py::print("CFD: computing matching points for distance ", dist.value, " from center_curve of complexity ", center_curve.complexity(), " to input_curve of complexity ", input_curve.complexity());
+    if (options.verbosity > 1) py::print("CFD: computing matching points for distance ", dist.value, " from center_curve of complexity ", center_curve.complexity(), " to input_curve of complexity ", input_curve.complexity());
     
     const distance_t dist_sqr = dist.value * dist.value;
     const curve_size_t n1 = center_curve.complexity();
     const curve_size_t n2 = input_curve.complexity();
 
-    std::vector<Intervals> free_intervals(n1, Intervals(n2, Interval()));
-        
-    #pragma omp parallel for collapse(2) if (n1 * n2 > 1000)
-    for (curve_size_t i = 1; i < n1; ++i) {
-        for (curve_size_t j = 0; j < n2 - 1; ++j) {
-            free_intervals[i][j] = center_curve[i].ball_intersection_interval(dist_sqr, input_curve[j], input_curve[j+1]);
-        }
-    }
-    
-    if (Config::verbosity > 1) py::print("CFD: free space computed, computing matching");
+    if (options.verbosity > 1) py::print("CFD: computing matching");
     
     Points result(n1, center_curve.dimensions());
-    parameter_t p;
+    parameter_t p = 0;
     curve_size_t jj(0);
         
     for (curve_size_t i = 1; i < n1 - 1; ++i) {
-        if (Config::verbosity > 1) py::print("CFD: computing matching points for vertex ", i);
+        if (options.verbosity > 1) py::print("CFD: computing matching points for vertex ", i);
+        // only the free intervals of vertex i are needed, from the segment matched to the last vertex on
+        Lazy_Free_Intervals<0, true> free_intervals(dist_sqr, center_curve, input_curve, i);
         for (curve_size_t j = jj; j < n2 - 1; ++j, p = 0) {
-            if (not free_intervals[i][j].empty()) {
+            const Interval &free_interval = free_intervals[j];
+            if (not free_interval.empty()) {
                 if (j == jj) {
-                    p = std::max(p, free_intervals[i][j].begin());
+                    p = std::max(p, free_interval.begin());
                     break;
                 }
-                p = free_intervals[i][j].begin();
+                p = free_interval.begin();
                 jj = j;
                 break;
             }
         }
         result[i] = input_curve[jj].line_segment_point(input_curve[jj+1], p);
-        if (Config::verbosity > 1) py::print("CFD: matching vertex ", i, "to ", p, "on segment ", jj, " to ", jj+1, " with distance ", result[i].dist(center_curve[i]));
+        if (options.verbosity > 1) py::print("CFD: matching vertex ", i, "to ", p, "on segment ", jj, " to ", jj+1, " with distance ", result[i].dist(center_curve[i]));
     }
     result[0] = input_curve[0];
     result[n1-1] = input_curve[n2-1];
@@ -77,52 +102,65 @@ Points vertices_matching_points(const Curve &input_curve, const Curve &center_cu
     return result;
 }
 
-Distance distance(const Curve &curve1, const Curve &curve2) {
+Distance distance(const Curve &curve1, const Curve &curve2, const bool exact, const Budget &budget, const Config::Options &options) {
+    const auto call = std::chrono::steady_clock::now();
     if ((curve1.complexity() < 2) or (curve2.complexity() < 2)) {
         py::print("WARNING: comparison possible only for curves of at least two points");
         Distance result;
-        result.value = std::numeric_limits<distance_t>::signaling_NaN();
+        result.value = result.lower_bound = result.upper_bound = std::numeric_limits<distance_t>::signaling_NaN();
         return result;
     }
     if (curve1.dimensions() != curve2.dimensions()) {
         py::print("WARNING: comparison possible only for curves of equal number of dimensions");
         Distance result;
-        result.value = std::numeric_limits<distance_t>::signaling_NaN();
+        result.value = result.lower_bound = result.upper_bound = std::numeric_limits<distance_t>::signaling_NaN();
         return result;
     }
     
     const auto start = std::clock();
-    if (Config::verbosity > 2) py::print("CFD: computing lower bound");
+    if (options.verbosity > 2) py::print("CFD: computing lower bound");
     const distance_t lb = _projective_lower_bound(curve1, curve2);
-    if (Config::verbosity > 2) py::print("CFD: computing upper bound");
+    if (options.verbosity > 2) py::print("CFD: computing upper bound");
     const distance_t ub = _greedy_upper_bound(curve1, curve2);
     const auto end = std::clock();
     
-    auto dist = _distance(curve1, curve2, ub, lb);
+    auto dist = exact ? _exact_distance(curve1, curve2, ub, lb, budget, call, options) : _distance(curve1, curve2, ub, lb, budget, call, options);
     dist.time_bounds = (end - start) / CLOCKS_PER_SEC;
     dist.time = dist.time_bounds + dist.time_searches;
 
     return dist;
 }
 
-Distance _distance(const Curve &curve1, const Curve &curve2, distance_t ub, distance_t lb) {
+bool less_than_or_equal(const distance_t distance, const Curve &curve1, const Curve &curve2, const Config::Options &options) {
+    if ((curve1.complexity() < 2) or (curve2.complexity() < 2)) {
+        py::print("WARNING: comparison possible only for curves of at least two points");
+        return false;
+    }
+    if (curve1.dimensions() != curve2.dimensions()) {
+        py::print("WARNING: comparison possible only for curves of equal number of dimensions");
+        return false;
+    }
+    
+    // cheapest filters first, most pairs are decided without a free space diagram
+    const distance_t dist_sqr = distance * distance;
+    if (curve1.front().dist_sqr(curve2.front()) > dist_sqr or curve1.back().dist_sqr(curve2.back()) > dist_sqr) return false;
+    if (_greedy_upper_bound(curve1, curve2) <= distance) return true;
+    if (_projective_lower_bound(curve1, curve2) > distance) return false;
+    
+    return _less_than_or_equal(distance, curve1, curve2, options);
+}
+
+Distance _distance(const Curve &curve1, const Curve &curve2, distance_t ub, distance_t lb, const Budget &budget, const std::chrono::steady_clock::time_point call, const Config::Options &options) {
     Distance result;
     const auto start = std::clock();
     
     distance_t split = (ub + lb)/2;
-    const distance_t p_error = lb * error / 100 > std::numeric_limits<distance_t>::epsilon() ? lb * error / 100 : std::numeric_limits<distance_t>::epsilon();
+    const distance_t p_error = lb * options.continuous_frechet_error / 100 > std::numeric_limits<distance_t>::epsilon() ? lb * options.continuous_frechet_error / 100 : std::numeric_limits<distance_t>::epsilon();
     std::size_t number_searches = 0;
     
     if (ub - lb > p_error) {
-        if (Config::verbosity > 2) py::print("CFD: binary search using FSD, error = ", p_error);
+        if (options.verbosity > 2) py::print("CFD: binary search using FSD, error = ", p_error);
         
-        const auto infty = std::numeric_limits<parameter_t>::infinity();
-        std::vector<Parameters> reachable1(curve1.complexity() - 1, Parameters(curve2.complexity(), infty));
-        std::vector<Parameters> reachable2(curve1.complexity(), Parameters(curve2.complexity() - 1, infty));
-        
-        std::vector<Intervals> free_intervals1(curve2.complexity(), Intervals(curve1.complexity(), Interval()));
-        std::vector<Intervals> free_intervals2(curve1.complexity(), Intervals(curve2.complexity(), Interval()));
-
         if (std::isnan(lb) or std::isnan(ub)) {
             result.value = std::numeric_limits<distance_t>::signaling_NaN();
             return result;
@@ -132,102 +170,227 @@ Distance _distance(const Curve &curve1, const Curve &curve2, distance_t ub, dist
         
         //Binary search over the feasible distances
         while (ub - lb > p_error) {
+            if (budget.exhausted(call, number_searches)) {
+                if (options.verbosity > 2) py::print("CFD: budget exhausted after ", number_searches, " searches");
+                break;
+            }
             ++number_searches;
             split = (ub + lb)/distance_t(2);
             if (split == lb or split == ub) break;
-            isLessThan = _less_than_or_equal(split, curve1, curve2, reachable1, reachable2, free_intervals1, free_intervals2);
+            isLessThan = _less_than_or_equal(split, curve1, curve2, options);
             if (isLessThan) {
                 ub = split;
             }
             else {
                 lb = split;
             }
-            if (Config::verbosity > 2) py::print("CFD: narrowed distance to to [", lb, ", ", ub, "]");
+            if (options.verbosity > 2) py::print("CFD: narrowed distance to to [", lb, ", ", ub, "]");
         }
     }
     
     const auto end = std::clock();
     result.value = ub;
+    result.lower_bound = lb;
+    result.upper_bound = ub;
     result.time_searches = (end - start) / CLOCKS_PER_SEC;
     result.number_searches = number_searches;
     return result;
 }
 
-bool _less_than_or_equal(const distance_t distance, Curve const& curve1, Curve const& curve2, 
-        std::vector<Parameters> &reachable1, std::vector<Parameters> &reachable2,
-        std::vector<Intervals> &free_intervals1, std::vector<Intervals> &free_intervals2) {
+/*
+ * Sweeps the reachable space row by row. Free intervals are only computed for cells that can be entered
+ * and the sweep stops as soon as no cell of a row is reachable.
+ */
+template<dimensions_t D, class P>
+bool _less_than_or_equal(const distance_t distance, Curve const& curve1, Curve const& curve2, Basic_Workspace<P> &workspace, const Config::Options &options) {
     
-    if (Config::verbosity > 2) py::print("CFD: constructing FSD");
+    if (options.verbosity > 2) py::print("CFD: deciding using FSD");
     const distance_t dist_sqr = distance * distance;
-    const auto infty = std::numeric_limits<parameter_t>::infinity();
+    const auto infty = std::numeric_limits<P>::infinity();
     const curve_size_t n1 = curve1.complexity();
     const curve_size_t n2 = curve2.complexity();
-
-    if (Config::verbosity > 2) py::print("CFD: resetting old FSD");
     
-    #pragma omp parallel for collapse(2) if (n1 * n2 > 1000)
-    for (curve_size_t i = 0; i < n1; ++i) {
-        for (curve_size_t j = 0; j < n2; ++j) {
-            if (i < n1 - 1) reachable1[i][j] = infty;
-            if (j < n2 - 1) reachable2[i][j] = infty;
-            free_intervals1[j][i].reset();
-            free_intervals2[i][j].reset();
-        }
+    workspace.resize(n2);
+    std::vector<P> &reachable1 = workspace.reachable1, &reachable2 = workspace.reachable2;
+    std::vector<P> &previous_reachable1 = workspace.previous_reachable1, &previous_reachable2 = workspace.previous_reachable2;
+    
+    // the left border: vertex 0 of curve1 is reachable on a prefix of curve2
+    bool free = true;
+    for (curve_size_t j = 0; j < n2 - 1; ++j) {
+        reachable2[j] = free ? 0 : infty;
+        free = free and curve1[0].dist_sqr<D>(curve2[j+1]) <= dist_sqr;
     }
     
-    if (Config::verbosity > 2) py::print("CFD: FSD borders");
+    // the bottom border: vertex 0 of curve2 is reachable on a prefix of curve1
+    bool border = true;
     
     for (curve_size_t i = 0; i < n1 - 1; ++i) {
-        reachable1[i][0] = 0;
-        if (curve2[0].dist_sqr(curve1[i+1]) > dist_sqr) break;
+        // in the first row the left border is reachable at least in its origin
+        bool any = i == 0;
+        
+        if (i > 0) {
+            std::swap(reachable1, previous_reachable1);
+            std::swap(reachable2, previous_reachable2);
+            
+            Lazy_Free_Intervals<D, true, Basic_Interval<P>> free_intervals(dist_sqr, curve1, curve2, i);
+            for (curve_size_t j = 0; j < n2 - 1; ++j) {
+                P reachable = infty;
+                if (previous_reachable1[j] != infty or previous_reachable2[j] != infty) {
+                    const Basic_Interval<P> &free_interval = free_intervals[j];
+                    if (not free_interval.empty()) {
+                        if (previous_reachable1[j] != infty) {
+                            reachable = free_interval.begin();
+                        }
+                        else if (previous_reachable2[j] <= free_interval.end()) {
+                            reachable = std::max(free_interval.begin(), previous_reachable2[j]);
+                        }
+                    }
+                }
+                reachable2[j] = reachable;
+                any = any or reachable != infty;
+            }
+        }
+        
+        reachable1[0] = border ? 0 : infty;
+        any = any or border;
+        border = border and curve2[0].dist_sqr<D>(curve1[i+1]) <= dist_sqr;
+        
+        Lazy_Free_Intervals<D, false, Basic_Interval<P>> free_intervals(dist_sqr, curve1, curve2, i);
+        for (curve_size_t j = 1; j < n2; ++j) {
+            P reachable = infty;
+            if (reachable2[j-1] != infty or reachable1[j-1] != infty) {
+                const Basic_Interval<P> &free_interval = free_intervals[j];
+                if (not free_interval.empty()) {
+                    if (reachable2[j-1] != infty) {
+                        reachable = free_interval.begin();
+                    }
+                    else if (reachable1[j-1] <= free_interval.end()) {
+                        reachable = std::max(free_interval.begin(), reachable1[j-1]);
+                    }
+                }
+            }
+            reachable1[j] = reachable;
+            any = any or reachable != infty;
+        }
+        
+        if (not any) {
+            if (options.verbosity > 2) py::print("CFD: reachable space ends in row ", i);
+            return false;
+        }
     }
     
-    for (curve_size_t j = 0; j < n2 - 1; ++j) {
-        reachable2[0][j] = 0;
-        if (curve1[0].dist_sqr(curve2[j+1]) > dist_sqr) break;
+    return reachable1[n2 - 1] < infty;
+}
+
+template<dimensions_t D>
+bool _less_than_or_equal(const distance_t distance, Curve const& curve1, Curve const& curve2, const Config::Options &options) {
+    if (options.continuous_frechet_compact) return _less_than_or_equal<D>(distance, curve1, curve2, Compact_Workspace::local(), options);
+    else return _less_than_or_equal<D>(distance, curve1, curve2, Workspace::local(), options);
+}
+
+bool _less_than_or_equal(const distance_t distance, Curve const& curve1, Curve const& curve2, const Config::Options &options) {
+    
+    switch (curve1.dimensions()) {
+        case 1:
+            return _less_than_or_equal<1>(distance, curve1, curve2, options);
+        case 2:
+            return _less_than_or_equal<2>(distance, curve1, curve2, options);
+        case 3:
+            return _less_than_or_equal<3>(distance, curve1, curve2, options);
+        default:
+            return _less_than_or_equal<0>(distance, curve1, curve2, options);
     }
+}
+
+template<dimensions_t D>
+distance_t _segment_distance(const Curve &curve, const Const_Point_View &start, const Const_Point_View &end) {
+    const curve_size_t n = curve.complexity();
+    const dimensions_t d = D > 0 ? D : curve.dimensions();
+    const coordinate_t *s = start.data(), *e = end.data();
     
-    if (Config::verbosity > 2) py::print("CFD: computing free space");
+    distance_t result = std::max(curve.front().dist<D>(start), curve.back().dist<D>(end));
     
-    #pragma omp parallel for collapse(2) if (n1 * n2 > 1000)
-    for (curve_size_t i = 0; i < n1; ++i) {
-        for (curve_size_t j = 0; j < n2; ++j) {
-            if ((i < n1 - 1) and (j > 0)) {
-                free_intervals1[j][i] = curve2[j].ball_intersection_interval(dist_sqr, curve1[i], curve1[i+1]);
-            }
-            if ((j < n2 - 1) and (i > 0)) {
-                free_intervals2[i][j] = curve1[i].ball_intersection_interval(dist_sqr, curve2[j], curve2[j+1]);
-            }
+    distance_t length_sqr = 0;
+    for (dimensions_t k = 0; k < d; ++k) length_sqr += (e[k] - s[k]) * (e[k] - s[k]);
+    
+    if (length_sqr <= 0) {
+        for (curve_size_t i = 0; i < n; ++i) result = std::max(result, curve[i].dist<D>(start));
+        return result;
+    }
+    
+    const distance_t length = std::sqrt(length_sqr);
+    distance_t result_sqr = result * result;
+    
+    // position of the projection of every vertex along the segment and squared distance to the segment's line
+    static thread_local std::vector<distance_t> projection, height_sqr;
+    projection.resize(n);
+    height_sqr.resize(n);
+    
+    for (curve_size_t i = 0; i < n; ++i) {
+        const coordinate_t *x = curve[i].data();
+        distance_t vu = 0, height = 0, temp;
+        for (dimensions_t k = 0; k < d; ++k) vu += (x[k] - s[k]) * (e[k] - s[k]);
+        const distance_t t = vu / length_sqr;
+        for (dimensions_t k = 0; k < d; ++k) {
+            temp = s[k] + (e[k] - s[k]) * t - x[k];
+            height += temp * temp;
         }
+        projection[i] = t * length;
+        height_sqr[i] = height;
+        const distance_t outside = std::max(std::max(-projection[i], projection[i] - length), distance_t(0));
+        result_sqr = std::max(result_sqr, height + outside * outside);
     }
+    result = std::max(result, std::sqrt(result_sqr));
     
-    if (Config::verbosity > 2) py::print("CFD: computing reachable space");
+    // vertex i can be matched to the piece of the segment within radius(i) of its projection
+    const auto radius = [&](const curve_size_t i) {
+        return std::sqrt(std::max(result * result - height_sqr[i], distance_t(0)));
+    };
     
-    for (curve_size_t i = 0; i < n1; ++i) {
-        for (curve_size_t j = 0; j < n2; ++j) {
-            if ((i < n1 - 1) and (j > 0)) {
-                if (not free_intervals1[j][i].empty()) {
-                    if (reachable2[i][j-1] != infty) {
-                        reachable1[i][j] = free_intervals1[j][i].begin();
-                    }
-                    else if (reachable1[i][j-1] <= free_intervals1[j][i].end()) {
-                        reachable1[i][j] = std::max(free_intervals1[j][i].begin(), reachable1[i][j-1]);
-                    }
-                }
-            }
-            if ((j < n2 - 1) and (i > 0)) {
-                if (not free_intervals2[i][j].empty()) {
-                    if (reachable1[i-1][j] != infty) {
-                        reachable2[i][j] = free_intervals2[i][j].begin();
-                    }
-                    else if (reachable2[i-1][j] <= free_intervals2[i][j].end()) {
-                        reachable2[i][j] = std::max(free_intervals2[i][j].begin(), reachable2[i-1][j]);
-                    }
+    curve_size_t latest = 0;
+    distance_t latest_start = projection[0] - radius(0), radius_l;
+    
+    for (curve_size_t l = 1; l < n; ++l) {
+        radius_l = radius(l);
+        
+        while (latest_start > projection[l] + radius_l) {
+            // raise to the distance of both vertices to the point between their projections that is equidistant to them
+            const distance_t gap = projection[latest] - projection[l], difference = (height_sqr[l] - height_sqr[latest]) / gap;
+            const distance_t radius_latest = std::max((gap + difference) / 2, distance_t(0));
+            const distance_t raised = std::sqrt(height_sqr[latest] + radius_latest * radius_latest);
+            if (not (raised > result)) break;
+            result = raised;
+            
+            latest_start = -std::numeric_limits<distance_t>::infinity();
+            for (curve_size_t k = 0; k < l; ++k) {
+                if (projection[k] - radius(k) > latest_start) {
+                    latest_start = projection[k] - radius(k);
+                    latest = k;
                 }
             }
+            radius_l = radius(l);
+        }
+        
+        if (projection[l] - radius_l > latest_start) {
+            latest_start = projection[l] - radius_l;
+            latest = l;
         }
     }
-    return reachable1.back().back() < infty;
+    
+    return result;
+}
+
+distance_t segment_distance(const Curve &curve, const Const_Point_View &start, const Const_Point_View &end) {
+    switch (curve.dimensions()) {
+        case 1:
+            return _segment_distance<1>(curve, start, end);
+        case 2:
+            return _segment_distance<2>(curve, start, end);
+        case 3:
+            return _segment_distance<3>(curve, start, end);
+        default:
+            return _segment_distance<0>(curve, start, end);
+    }
 }
 
 distance_t _greedy_upper_bound(const Curve &curve1, const Curve &curve2) {
@@ -260,16 +423,17 @@ distance_t _greedy_upper_bound(const Curve &curve1, const Curve &curve2) {
     return std::sqrt(result);
 }
 
+template<dimensions_t D>
 distance_t _projective_lower_bound(const Curve &curve1, const Curve &curve2) {
     std::vector<distance_t> distances1_sqr = std::vector<distance_t>(curve2.complexity() - 1), distances2_sqr = std::vector<distance_t>(curve1.complexity() + curve2.complexity() + 2);
     
     for (curve_size_t i = 0; i < curve1.complexity(); ++i) {
         #pragma omp parallel for
         for (curve_size_t j = 0; j < curve2.complexity() - 1; ++j) {
-            if (curve2[j].dist_sqr(curve2[j+1]) > 0) {
-                distances1_sqr[j] = curve1[i].line_segment_dist_sqr(curve2[j], curve2[j+1]);
+            if (curve2[j].dist_sqr<D>(curve2[j+1]) > 0) {
+                distances1_sqr[j] = curve1[i].line_segment_dist_sqr<D>(curve2[j], curve2[j+1]);
             } else {
-                distances1_sqr[j] = curve1[i].dist_sqr(curve2[j]);
+                distances1_sqr[j] = curve1[i].dist_sqr<D>(curve2[j]);
             }
         }
         distances2_sqr[i] = *std::min_element(distances1_sqr.begin(), distances1_sqr.end());
@@ -280,20 +444,188 @@ distance_t _projective_lower_bound(const Curve &curve1, const Curve &curve2) {
     for (curve_size_t i = 0; i < curve2.complexity(); ++i) {
         #pragma omp parallel for
         for (curve_size_t j = 0; j < curve1.complexity() - 1; ++j) {
-            if (curve1[j].dist_sqr(curve1[j+1]) > 0) {
-                distances1_sqr[j] = curve2[i].line_segment_dist_sqr(curve1[j], curve1[j+1]);
+            if (curve1[j].dist_sqr<D>(curve1[j+1]) > 0) {
+                distances1_sqr[j] = curve2[i].line_segment_dist_sqr<D>(curve1[j], curve1[j+1]);
             } else {
-                distances1_sqr[j] = curve2[i].dist_sqr(curve1[j]);
+                distances1_sqr[j] = curve2[i].dist_sqr<D>(curve1[j]);
             }
         }
         distances2_sqr[curve1.complexity() + i] = *std::min_element(distances1_sqr.begin(), distances1_sqr.end());
     }
     
-    distances2_sqr[curve1.complexity() + curve2.complexity()] = curve1[0].dist_sqr(curve2[0]);
-    distances2_sqr[curve1.complexity() + curve2.complexity() + 1] = curve1[curve1.complexity()-1].dist_sqr(curve2[curve2.complexity()-1]);
+    distances2_sqr[curve1.complexity() + curve2.complexity()] = curve1[0].dist_sqr<D>(curve2[0]);
+    distances2_sqr[curve1.complexity() + curve2.complexity() + 1] = curve1[curve1.complexity()-1].dist_sqr<D>(curve2[curve2.complexity()-1]);
     return std::sqrt(*std::max_element(distances2_sqr.begin(), distances2_sqr.end()));
 }
 
+distance_t _projective_lower_bound(const Curve &curve1, const Curve &curve2) {
+    switch (curve1.dimensions()) {
+        case 1:
+            return _projective_lower_bound<1>(curve1, curve2);
+        case 2:
+            return _projective_lower_bound<2>(curve1, curve2);
+        case 3:
+            return _projective_lower_bound<3>(curve1, curve2);
+        default:
+            return _projective_lower_bound<0>(curve1, curve2);
+    }
+}
+
+/*
+ * The distance is one of the critical values of Alt and Godau: a distance between endpoints, between a vertex and a segment,
+ * or the distance of two vertices of one curve to the point on a segment of the other curve that is equidistant to both (monotonicity event).
+ */
+template<dimensions_t D>
+static void _vertex_segment_critical_values(const Curve &curve1, const Curve &curve2, const distance_t low, const distance_t high, std::vector<distance_t> &result) {
+    for (curve_size_t i = 0; i < curve1.complexity(); ++i) {
+        for (curve_size_t j = 0; j < curve2.complexity() - 1; ++j) {
+            const distance_t value = curve1[i].line_segment_dist<D>(curve2[j], curve2[j+1]);
+            if (value > low and value < high) result.push_back(value);
+        }
+    }
+}
+
+/*
+ * There are O(n1^2 n2) monotonicity values, so they are not all stored: every thread keeps a uniform sample of at most capacity values
+ * within (low, high), the number of all values within is returned.
+ */
+template<dimensions_t D>
+static std::size_t _monotonicity_critical_values(const Curve &curve1, const Curve &curve2, const distance_t low, const distance_t high, const std::size_t capacity, std::vector<distance_t> &result) {
+    const dimensions_t d = D > 0 ? D : curve1.dimensions();
+    const curve_size_t n1 = curve1.complexity();
+    const distance_t low_sqr = low * low, high_sqr = high * high;
+    std::size_t count = 0;
+    
+    #pragma omp parallel reduction(+: count)
+    {
+        std::vector<distance_t> local_result;
+        Random::Uniform_Random_Generator<parameter_t> ugen;
+        
+        // reservoir sampling
+        const auto sample = [&](const distance_t value) {
+            ++count;
+            if (local_result.size() < capacity) local_result.push_back(value);
+            else {
+                const std::size_t r = std::floor(count * ugen.get());
+                if (r < capacity) local_result[r] = value;
+            }
+        };
+        
+        #pragma omp for schedule(dynamic)
+        for (curve_size_t j = 0; j < curve2.complexity() - 1; ++j) {
+            const coordinate_t *a = curve2[j].data(), *b = curve2[j+1].data();
+            
+            // a + t(b - a) is equidistant to vertices k and l where it meets the bisector of both, which is computed from the difference
+            // of the vertices instead of their distances to a, as these cancel out for values that are small compared to the coordinates
+            for (curve_size_t k = 0; k < n1 - 1; ++k) {
+                const coordinate_t *p = curve1[k].data();
+                for (curve_size_t l = k + 1; l < n1; ++l) {
+                    const coordinate_t *q = curve1[l].data();
+                    distance_t numerator = 0, denominator = 0;
+                    for (dimensions_t m = 0; m < d; ++m) {
+                        numerator += ((p[m] + q[m]) / 2 - a[m]) * (q[m] - p[m]);
+                        denominator += (b[m] - a[m]) * (q[m] - p[m]);
+                    }
+                    if (denominator == 0) continue;
+                    const distance_t t = numerator / denominator;
+                    if (t < 0 or t > 1) continue;
+                    distance_t value_sqr = 0;
+                    for (dimensions_t m = 0; m < d; ++m) {
+                        const distance_t temp = a[m] + t * (b[m] - a[m]) - p[m];
+                        value_sqr += temp * temp;
+                    }
+                    if (value_sqr > low_sqr and value_sqr < high_sqr) sample(std::sqrt(value_sqr));
+                }
+            }
+        }
+        
+        #pragma omp critical
+        result.insert(result.end(), local_result.begin(), local_result.end());
+    }
+    return count;
+}
+
+template<dimensions_t D>
+Distance _exact_distance(const Curve &curve1, const Curve &curve2, distance_t ub, distance_t lb, const Budget &budget, const std::chrono::steady_clock::time_point call, const Config::Options &options) {
+    Distance result;
+    const auto start = std::clock();
+    std::size_t number_searches = 0;
+    
+    // at a critical value the free space degenerates to single points, which the decision procedure treats as empty; free intervals
+    // are computed from squared distances, which are rounded relative to the squared coordinates, so the squared value gets an absolute
+    // slack as well, which only matters for values of about the square root of the precision times the coordinates, at most
+    distance_t scale_sqr = 0;
+    for (const auto &curve : {&curve1, &curve2}) {
+        for (curve_size_t i = 0; i < curve->complexity(); ++i) {
+            for (dimensions_t k = 0; k < curve->dimensions(); ++k) scale_sqr = std::max(scale_sqr, (*curve)[i][k] * (*curve)[i][k]);
+        }
+    }
+    const distance_t slack = 1e-10, absolute_slack_sqr = 16 * std::numeric_limits<distance_t>::epsilon() * scale_sqr;
+    const auto decide = [&](const distance_t value) {
+        ++number_searches;
+        const distance_t value_slack = value * (1 + slack);
+        return _less_than_or_equal<D>(std::sqrt(value_slack * value_slack + absolute_slack_sqr), curve1, curve2, options);
+    };
+    
+    // binary search for the smallest positive candidate, narrows [lb, ub] to the two neighbouring candidates
+    const auto search = [&](std::vector<distance_t> &candidates) {
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+        curve_size_t low = 0, high = candidates.size();
+        while (low < high and not budget.exhausted(call, number_searches)) {
+            const curve_size_t mid = low + (high - low) / 2;
+            if (decide(candidates[mid])) high = mid;
+            else low = mid + 1;
+        }
+        if (high < candidates.size()) ub = candidates[high];
+        if (low > 0) lb = candidates[low - 1];
+        if (options.verbosity > 2) py::print("CFD: narrowed distance to to [", lb, ", ", ub, "] using ", candidates.size(), " critical values");
+    };
+    
+    if (not std::isnan(lb) and not std::isnan(ub) and lb < ub) {
+        if (decide(lb)) ub = lb;
+        else {
+            std::vector<distance_t> candidates;
+            _vertex_segment_critical_values<D>(curve1, curve2, lb, ub, candidates);
+            _vertex_segment_critical_values<D>(curve2, curve1, lb, ub, candidates);
+            search(candidates);
+            
+            // randomized selection, every search on a sample narrows [lb, ub] to a fraction of about 1/capacity of the values within
+            const std::size_t capacity = 16 * (curve1.complexity() + curve2.complexity());
+            bool complete = false;
+            while (not complete and not budget.exhausted(call, number_searches)) {
+                candidates.clear();
+                std::size_t count = _monotonicity_critical_values<D>(curve1, curve2, lb, ub, capacity, candidates);
+                count += _monotonicity_critical_values<D>(curve2, curve1, lb, ub, capacity, candidates);
+                complete = candidates.size() == count;
+                search(candidates);
+            }
+            if (not complete and options.verbosity > 2) py::print("CFD: budget exhausted after ", number_searches, " searches");
+        }
+    }
+    
+    const auto end = std::clock();
+    result.value = ub;
+    result.lower_bound = lb;
+    result.upper_bound = ub;
+    result.time_searches = (end - start) / CLOCKS_PER_SEC;
+    result.number_searches = number_searches;
+    return result;
+}
+
+Distance _exact_distance(const Curve &curve1, const Curve &curve2, distance_t ub, distance_t lb, const Budget &budget, const std::chrono::steady_clock::time_point call, const Config::Options &options) {
+    switch (curve1.dimensions()) {
+        case 1:
+            return _exact_distance<1>(curve1, curve2, ub, lb, budget, call, options);
+        case 2:
+            return _exact_distance<2>(curve1, curve2, ub, lb, budget, call, options);
+        case 3:
+            return _exact_distance<3>(curve1, curve2, ub, lb, budget, call, options);
+        default:
+            return _exact_distance<0>(curve1, curve2, ub, lb, budget, call, options);
+    }
+}
+
 } // end namespace Continuous
 
 namespace Discrete {
@@ -304,41 +636,162 @@ std::string Distance::repr() const {
     return ss.str();
 }
     
-Distance distance(const Curve &curve1, const Curve &curve2) {
-    Distance result;
-    const auto start = std::clock();
-    
-    std::vector<std::vector<distance_t>> a(curve1.complexity(), std::vector<distance_t>(curve2.complexity()));
-    std::vector<std::vector<distance_t>> dists(curve1.complexity(), std::vector<distance_t>(curve2.complexity()));
+// below this length of the shorter curve the anti-diagonals are too short to be worth sharing among threads
+static const curve_size_t wavefront_complexity = 4096;
+
+/*
+ * The dynamic program keeps only two rows of squared distances and computes the point distances on the fly.
+ * Every coupling passes each row, so the sweep is abandoned, returning infinity, once all cells of a row exceed the cutoff.
+ */
+template<dimensions_t D>
+distance_t _row_sweep(const Curve &curve1, const Curve &curve2, const distance_t cutoff) {
+    const curve_size_t n1 = curve1.complexity(), n2 = curve2.complexity();
+    std::vector<distance_t> previous(n2), current(n2);
+    
+    previous[0] = curve1[0].dist_sqr<D>(curve2[0]);
+    distance_t row_min = previous[0];
+    for (curve_size_t j = 1; j < n2; ++j) {
+        previous[j] = std::max(previous[j-1], curve1[0].dist_sqr<D>(curve2[j]));
+    }
+    if (std::sqrt(row_min) > cutoff) return std::numeric_limits<distance_t>::infinity();
     
-    #pragma omp parallel for collapse(2)
-    for (curve_size_t i = 0; i < curve1.complexity(); ++i) {
-        for (curve_size_t j = 0; j < curve2.complexity(); ++j) {
-            dists[i][j] = curve1[i].dist_sqr(curve2[j]);
+    for (curve_size_t i = 1; i < n1; ++i) {
+        current[0] = std::max(previous[0], curve1[i].dist_sqr<D>(curve2[0]));
+        row_min = current[0];
+        for (curve_size_t j = 1; j < n2; ++j) {
+            current[j] = std::max(std::min(std::min(previous[j], previous[j-1]), current[j-1]), curve1[i].dist_sqr<D>(curve2[j]));
+            row_min = std::min(row_min, current[j]);
         }
+        if (std::sqrt(row_min) > cutoff) return std::numeric_limits<distance_t>::infinity();
+        std::swap(previous, current);
     }
     
-    for (curve_size_t i = 0; i < curve1.complexity(); ++i) {
-        for (curve_size_t j = 0; j < curve2.complexity(); ++j) {
-            if (i == 0 and j == 0) a[i][j] = dists[i][j];
-            else if (i == 0 and j > 0) a[i][j] = std::max(a[i][j-1], dists[i][j]);
-            else if (i > 0 and j == 0) a[i][j] = std::max(a[i-1][j], dists[i][j]);
-            else {
-                a[i][j] = std::max(std::min(std::min(a[i-1][j], a[i-1][j-1]), a[i][j-1]), dists[i][j]);
-            }
+    return previous[n2 - 1];
+}
+
+/*
+ * The dynamic program swept along the anti-diagonals i + j = k, whose cells only depend on the two previous anti-diagonals.
+ * These three are kept, indexed by i, and the cells of each are computed in parallel.
+ * A diagonal step skips an anti-diagonal, but every coupling passes at least one of any two consecutive anti-diagonals,
+ * so the sweep is abandoned once the cells of two consecutive anti-diagonals all exceed the cutoff.
+ */
+template<dimensions_t D>
+distance_t _wavefront_sweep(const Curve &curve1, const Curve &curve2, const distance_t cutoff) {
+    const curve_size_t n1 = curve1.complexity(), n2 = curve2.complexity();
+    const auto infty = std::numeric_limits<distance_t>::infinity();
+    std::vector<distance_t> second_previous(n1, infty), previous(n1, infty), current(n1, infty);
+    
+    previous[0] = curve1[0].dist_sqr<D>(curve2[0]);
+    distance_t previous_min = previous[0];
+    
+    for (curve_size_t k = 1; k < n1 + n2 - 1; ++k) {
+        const curve_size_t first = k < n2 ? 0 : k - n2 + 1, last = std::min(k, n1 - 1);
+        distance_t diagonal_min = infty;
+        
+        #pragma omp parallel for reduction(min: diagonal_min) if (last - first >= wavefront_complexity)
+        for (curve_size_t i = first; i <= last; ++i) {
+            const curve_size_t j = k - i;
+            distance_t reachable;
+            if (i == 0) reachable = previous[i];
+            else if (j == 0) reachable = previous[i-1];
+            else reachable = std::min(std::min(previous[i], previous[i-1]), second_previous[i-1]);
+            current[i] = std::max(reachable, curve1[i].dist_sqr<D>(curve2[j]));
+            diagonal_min = std::min(diagonal_min, current[i]);
         }
+        
+        if (std::sqrt(std::min(previous_min, diagonal_min)) > cutoff) return infty;
+        previous_min = diagonal_min;
+        
+        std::swap(second_previous, previous);
+        std::swap(previous, current);
     }
     
-    const auto value = std::sqrt(a[curve1.complexity() - 1][curve2.complexity() - 1]);
+    return previous[n1 - 1];
+}
+
+template<dimensions_t D>
+Distance _distance(const Curve &curve1, const Curve &curve2, const distance_t cutoff) {
+    Distance result;
+    const auto start = std::clock();
+    
+    const distance_t value = std::min(curve1.complexity(), curve2.complexity()) >= wavefront_complexity ? _wavefront_sweep<D>(curve1, curve2, cutoff) : _row_sweep<D>(curve1, curve2, cutoff);
     
     auto end = std::clock();
     
     result.time = (end - start) / CLOCKS_PER_SEC;
-    result.value = value;
+    result.value = std::sqrt(value);
     return result;
     
 }
 
+Distance distance(const Curve &curve1, const Curve &curve2, const distance_t cutoff) {
+    switch (curve1.dimensions()) {
+        case 1:
+            return _distance<1>(curve1, curve2, cutoff);
+        case 2:
+            return _distance<2>(curve1, curve2, cutoff);
+        case 3:
+            return _distance<3>(curve1, curve2, cutoff);
+        default:
+            return _distance<0>(curve1, curve2, cutoff);
+    }
+}
+
+template<dimensions_t D>
+bool _less_than_or_equal(const distance_t distance, const Curve &curve1, const Curve &curve2) {
+    const distance_t dist_sqr = distance * distance;
+    const curve_size_t n1 = curve1.complexity(), n2 = curve2.complexity();
+    
+    // reachable cells of the previous and the current row of the dynamic program
+    std::vector<char> previous(n2), current(n2);
+    
+    bool free = true;
+    for (curve_size_t j = 0; j < n2; ++j) {
+        free = free and curve1[0].dist_sqr<D>(curve2[j]) <= dist_sqr;
+        previous[j] = free;
+    }
+    
+    for (curve_size_t i = 1; i < n1; ++i) {
+        bool any = false;
+        for (curve_size_t j = 0; j < n2; ++j) {
+            const bool reachable = previous[j] or (j > 0 and (previous[j-1] or current[j-1]));
+            current[j] = reachable and curve1[i].dist_sqr<D>(curve2[j]) <= dist_sqr;
+            any = any or current[j];
+        }
+        if (not any) return false;
+        std::swap(previous, current);
+    }
+    
+    return previous[n2 - 1];
+}
+
+bool less_than_or_equal(const distance_t distance, const Curve &curve1, const Curve &curve2) {
+    if ((curve1.complexity() < 1) or (curve2.complexity() < 1)) {
+        py::print("WARNING: comparison possible only for curves of at least one point");
+        return false;
+    }
+    if (curve1.dimensions() != curve2.dimensions()) {
+        py::print("WARNING: comparison possible only for curves of equal number of dimensions");
+        return false;
+    }
+    
+    // the greedy upper bound is a coupling of the vertices, hence it bounds the discrete distance as well
+    const distance_t dist_sqr = distance * distance;
+    if (curve1.front().dist_sqr(curve2.front()) > dist_sqr or curve1.back().dist_sqr(curve2.back()) > dist_sqr) return false;
+    if (Continuous::_greedy_upper_bound(curve1, curve2) <= distance) return true;
+    
+    switch (curve1.dimensions()) {
+        case 1:
+            return _less_than_or_equal<1>(distance, curve1, curve2);
+        case 2:
+            return _less_than_or_equal<2>(distance, curve1, curve2);
+        case 3:
+            return _less_than_or_equal<3>(distance, curve1, curve2);
+        default:
+            return _less_than_or_equal<0>(distance, curve1, curve2);
+    }
+}
+
 } // end namespace Discrete
 
 } // end namespace Frechet
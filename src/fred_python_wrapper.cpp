@@ -23,6 +23,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 //#include "grid.hpp"
 #include "simplification.hpp"
 #include "dynamic_time_warping.hpp"
+#include "dataset.hpp"
+#include "batch.hpp"
 
 namespace py = pybind11;
 
@@ -30,21 +32,26 @@ namespace fc = Frechet::Continuous;
 namespace fd = Frechet::Discrete;
 namespace ddtw = Dynamic_Time_Warping::Discrete;
 
-Curve fr_minimum_error_simplification(const Curve &curve, const curve_size_t l) {
-    fc::Simplification::Subcurve_Shortcut_Graph graph(const_cast<Curve&>(curve));
+// options of a call, the global configuration if None is given
+Config::Options call_options(const Config::Options *options) {
+    return options ? *options : Config::Options();
+}
+
+Curve fr_minimum_error_simplification(const Curve &curve, const curve_size_t l, const Config::Options *options) {
+    fc::Simplification::Subcurve_Shortcut_Graph graph(curve, call_options(options));
     auto scurve = graph.minimum_error_simplification(l);
     scurve.set_name("Simplification of " + curve.get_name());
     return scurve;
 }
 
-Curve fr_approximate_minimum_link_simplification(const Curve &curve, const distance_t epsilon) {
-    auto scurve = fc::Simplification::approximate_minimum_link_simplification(curve, epsilon);
+Curve fr_approximate_minimum_link_simplification(const Curve &curve, const distance_t epsilon, const Config::Options *options) {
+    auto scurve = fc::Simplification::approximate_minimum_link_simplification(curve, epsilon, call_options(options));
     scurve.set_name("Simplification of " + curve.get_name());
     return scurve;
 }
 
-Curve fr_approximate_minimum_error_simplification(const Curve &curve, const curve_size_t ell) {
-    auto scurve = fc::Simplification::approximate_minimum_error_simplification(curve, ell);
+Curve fr_approximate_minimum_error_simplification(const Curve &curve, const curve_size_t ell, const Config::Options *options) {
+    auto scurve = fc::Simplification::approximate_minimum_error_simplification(curve, ell, call_options(options));
     scurve.set_name("Simplification of " + curve.get_name());
     return scurve;
 }
@@ -60,10 +67,14 @@ PYBIND11_MODULE(backend, m) {
     py::class_<Config::Config>(m, "Config")
         .def(py::init<>())
         .def_property("available_memory", [&](Config::Config&) { return Config::available_memory; }, [&](Config::Config&, const std::size_t available_memory) { Config::available_memory = available_memory; })
-        .def_property("continuous_frechet_error", [&](Config::Config&) { return fc::error; }, [&](Config::Config&, const distance_t error) { fc::error = error; })
+        .def_property("continuous_frechet_error", [&](Config::Config&) { return Config::continuous_frechet_error; }, [&](Config::Config&, const distance_t error) { Config::continuous_frechet_error = error; })
+        .def_property("continuous_frechet_compact", [&](Config::Config&) { return Config::continuous_frechet_compact; }, [&](Config::Config&, const bool compact) { Config::continuous_frechet_compact = compact; })
         .def_property("verbosity", [&](Config::Config&) { return &Config::verbosity; }, [&](Config::Config&, const unsigned int verbosity) { Config::verbosity = verbosity; })
         .def_property("use_distance_matrix", [&](Config::Config&) { return &Config::use_distance_matrix; }, [&](Config::Config&, const bool use_distance_matrix) { Config::use_distance_matrix = use_distance_matrix; })
         .def_property("dtw_contingency", [&](Config::Config&) { return &Config::dtw_contingency; }, [&](Config::Config&, const bool dtw_contingency) { Config::dtw_contingency = dtw_contingency; })
+        .def_property("dtw_sakoe_chiba_radius", [&](Config::Config&) { return Config::dtw_sakoe_chiba_radius; }, [&](Config::Config&, const long radius) { Config::dtw_sakoe_chiba_radius = radius; })
+        .def_property("dtw_itakura_slope", [&](Config::Config&) { return Config::dtw_itakura_slope; }, [&](Config::Config&, const distance_t slope) { Config::dtw_itakura_slope = slope; })
+        .def_property("dtw_approximation_radius", [&](Config::Config&) { return Config::dtw_approximation_radius; }, [&](Config::Config&, const long radius) { Config::dtw_approximation_radius = radius; })
         .def_property("number_threads", [&](Config::Config&){ return &Config::number_threads; }, [&](Config::Config&, const int number_threads) {
             if (number_threads <= 0) {
                 Config::number_threads = -1;
@@ -79,6 +90,19 @@ PYBIND11_MODULE(backend, m) {
         })
     ;
     
+    py::class_<Config::Options>(m, "Options")
+        .def(py::init<>())
+        .def_readwrite("available_memory", &Config::Options::available_memory)
+        .def_readwrite("verbosity", &Config::Options::verbosity)
+        .def_readwrite("use_distance_matrix", &Config::Options::use_distance_matrix)
+        .def_readwrite("dtw_contingency", &Config::Options::dtw_contingency)
+        .def_readwrite("dtw_sakoe_chiba_radius", &Config::Options::dtw_sakoe_chiba_radius)
+        .def_readwrite("dtw_itakura_slope", &Config::Options::dtw_itakura_slope)
+        .def_readwrite("dtw_approximation_radius", &Config::Options::dtw_approximation_radius)
+        .def_readwrite("continuous_frechet_error", &Config::Options::continuous_frechet_error)
+        .def_readwrite("continuous_frechet_compact", &Config::Options::continuous_frechet_compact)
+    ;
+    
     py::class_<Point>(m, "Point")
         .def(py::init<dimensions_t>())
         .def("__len__", &Point::dimensions)
@@ -93,9 +117,9 @@ PYBIND11_MODULE(backend, m) {
     py::class_<Points>(m, "Points")
         .def(py::init<dimensions_t>())
         .def("__len__", &Points::number)
-        .def("__getitem__", &Points::get, py::return_value_policy::reference)
+        .def("__getitem__", &Points::get)
         .def("__str__", &Points::str)
-        .def("__iter__", [](Points &v) { return py::make_iterator(v.begin(), v.end()); }, py::keep_alive<0, 1>())
+        .def("__iter__", [](const Points &v) { return py::make_iterator<py::return_value_policy::move, Points::const_iterator, Points::const_iterator, Point>(v.begin(), v.end()); }, py::keep_alive<0, 1>())
         .def("__repr__", &Points::repr)
         .def("add", &Points::add)
         .def_property_readonly("values", &Points::as_ndarray)
@@ -103,17 +127,16 @@ PYBIND11_MODULE(backend, m) {
     ;
     
     py::class_<Curve>(m, "Curve")
-        .def(py::init<py::array_t<coordinate_t>>())
-        .def(py::init<py::array_t<coordinate_t>, std::string>())
+        .def(py::init<py::array_t<coordinate_t>, std::string, bool>(), py::arg("values"), py::arg("name") = "unnamed curve", py::arg("copy") = true)
         .def_property_readonly("dimensions", &Curve::dimensions)
         .def_property_readonly("complexity", &Curve::complexity)
         .def_property("name", &Curve::get_name, &Curve::set_name)
         .def_property_readonly("values", &Curve::as_ndarray)
         .def_property_readonly("centroid", &Curve::centroid)
-        .def("__getitem__", &Curve::get, py::return_value_policy::reference)
+        .def("__getitem__", &Curve::get)
         .def("__len__", &Curve::complexity)
         .def("__str__", &Curve::str)
-        .def("__iter__", [](Curve &v) { return py::make_iterator(v.begin(), v.end()); }, py::keep_alive<0, 1>())
+        .def("__iter__", [](const Curve &v) { return py::make_iterator<py::return_value_policy::move, Curve::const_iterator, Curve::const_iterator, Point>(v.begin(), v.end()); }, py::keep_alive<0, 1>())
         .def("__repr__", &Curve::repr)
         .def(py::pickle(
             [](const Curve &c) {
@@ -122,15 +145,23 @@ PYBIND11_MODULE(backend, m) {
             [](py::tuple t) {
                 const auto coords = t[0].cast<py::array_t<coordinate_t>>();
                 const auto name = t[1].cast<std::string>();
-                return Curve(coords, name);
+                return Curve(coords, name, false);
             } ))
     ;
         
     py::class_<Curves>(m, "Curves")
         .def(py::init<>())
+        .def(py::init([](const py::array_t<coordinate_t> &values, const py::object &offsets, const bool copy) {
+            if (offsets.is_none()) return Curves(values, copy);
+            return Curves(values, offsets.cast<py::array_t<curve_size_t>>(), copy);
+        }), py::arg("values"), py::arg("offsets") = py::none(), py::arg("copy") = true)
         .def_property_readonly("m", &Curves::get_m)
         .def("add", &Curves::add)
-        .def("simplify", &Curves::simplify)
+        .def("simplify", [](Curves &curves, const curve_size_t l, const bool approx, const py::object &progress, const Config::Options *options) {
+            return Batch::simplify(curves, l, approx, progress, call_options(options));
+        }, py::arg("l"), py::arg("approx") = false, py::arg("progress") = py::none(), py::arg("options") = py::none())
+        .def("save", &Dataset::save, py::arg("path"), py::arg("names") = true)
+        .def_static("load", &Dataset::load, py::arg("path"), py::call_guard<py::gil_scoped_release>())
         .def("__getitem__", &Curves::get, py::return_value_policy::reference)
         .def("__setitem__", &Curves::set)
         .def("__add__", &Curves::operator+)
@@ -154,7 +185,8 @@ PYBIND11_MODULE(backend, m) {
                     const auto t = elem.cast<py::tuple>();
                     const auto coords = t[0].cast<py::array_t<coordinate_t>>();
                     const auto name = t[1].cast<std::string>();
-                    result.push_back(Curve(coords, name));
+                    Curve curve(coords, name, false);
+                    result.add(curve);
                 }
                 return result;
             } ))
@@ -164,6 +196,8 @@ PYBIND11_MODULE(backend, m) {
         .def_readwrite("time_searches", &fc::Distance::time_searches)
         .def_readwrite("time_bounds", &fc::Distance::time_bounds)
         .def_readwrite("number_searches", &fc::Distance::number_searches)
+        .def_readwrite("lower_bound", &fc::Distance::lower_bound)
+        .def_readwrite("upper_bound", &fc::Distance::upper_bound)
         .def_readwrite("value", &fc::Distance::value)
         .def("__repr__", &fc::Distance::repr)
     ;
@@ -205,18 +239,44 @@ PYBIND11_MODULE(backend, m) {
         .def("cost", &Coreset::Median_Coreset::cost)
     ;
     
-    m.def("continuous_frechet", &fc::distance);
-    m.def("discrete_frechet", &fd::distance);
-    m.def("discrete_dynamic_time_warping", &ddtw::distance);
+    m.def("continuous_frechet", [](const Curve &curve1, const Curve &curve2, const bool exact, const double time_budget, const std::size_t max_searches, const Config::Options *options) {
+        fc::Budget budget;
+        budget.seconds = time_budget;
+        budget.searches = max_searches;
+        return fc::distance(curve1, curve2, exact, budget, call_options(options));
+    }, py::arg("curve1"), py::arg("curve2"), py::arg("exact") = false, py::arg("time_budget") = 0, py::arg("max_searches") = 0, py::arg("options") = py::none());
+    m.def("discrete_frechet", &fd::distance, py::arg("curve1"), py::arg("curve2"), py::arg("cutoff") = std::numeric_limits<distance_t>::infinity());
+    m.def("discrete_dynamic_time_warping", [](const Curve &curve1, const Curve &curve2, const distance_t cutoff, const Config::Options *options) {
+        return ddtw::distance(curve1, curve2, cutoff, call_options(options), false);
+    }, py::arg("curve1"), py::arg("curve2"), py::arg("cutoff") = std::numeric_limits<distance_t>::infinity(), py::arg("options") = py::none());
+    
+    m.def("distances", [](const Curve &query, const Curves &curves, const unsigned int distance_func, const Config::Options *options) {
+        return Batch::distances(query, curves, distance_func, call_options(options));
+    }, py::arg("query"), py::arg("curves"), py::arg("distance_func") = 0, py::arg("options") = py::none());
+    m.def("pairwise_distances", [](const Curves &curves1, const py::object &curves2, const unsigned int distance_func, const Config::Options *options) {
+        if (curves2.is_none()) return Batch::pairwise_distances(curves1, distance_func, call_options(options));
+        return Batch::pairwise_distances(curves1, curves2.cast<Curves>(), distance_func, call_options(options));
+    }, py::arg("curves1"), py::arg("curves2") = py::none(), py::arg("distance_func") = 0, py::arg("options") = py::none());
+    
+    m.def("frechet_less_than", [](const Curve &curve1, const Curve &curve2, const distance_t delta, const bool discrete, const Config::Options *options) {
+        return discrete ? fd::less_than_or_equal(delta, curve1, curve2) : fc::less_than_or_equal(delta, curve1, curve2, call_options(options));
+    }, py::arg("curve1"), py::arg("curve2"), py::arg("delta"), py::arg("discrete") = false, py::arg("options") = py::none());
+    m.def("frechet_less_than", [](const Curve &query, const Curves &curves, const distance_t delta, const bool discrete, const Config::Options *options) {
+        return Batch::less_than_or_equal(query, curves, delta, discrete, call_options(options));
+    }, py::arg("query"), py::arg("curves"), py::arg("delta"), py::arg("discrete") = false, py::arg("options") = py::none());
     
-    m.def("frechet_minimum_error_simplification", &fr_minimum_error_simplification);
-    m.def("frechet_approximate_minimum_link_simplification", &fr_approximate_minimum_link_simplification);
-    m.def("frechet_approximate_minimum_error_simplification", &fr_approximate_minimum_error_simplification);
+    m.def("frechet_minimum_error_simplification", &fr_minimum_error_simplification, py::arg("curve"), py::arg("l"), py::arg("options") = py::none());
+    m.def("frechet_approximate_minimum_link_simplification", &fr_approximate_minimum_link_simplification, py::arg("curve"), py::arg("epsilon"), py::arg("options") = py::none());
+    m.def("frechet_approximate_minimum_error_simplification", &fr_approximate_minimum_error_simplification, py::arg("curve"), py::arg("l"), py::arg("options") = py::none());
     m.def("dtw_approximate_minimum_error_simplification", &dtw_approximate_minimum_error_simplification);
     
     m.def("dimension_reduction", &JLTransform::transform_naive, py::arg("curves"), py::arg("epsilon") = 0.5, py::arg("empirical_constant") = true);
 
-    m.def("discrete_klcenter", &Clustering::kl_center, py::arg("k") = 2, py::arg("l") = 2, py::arg("curves"), py::arg("local_search") = 0, py::arg("consecutive_call") = false, py::arg("random_first_center") = true, py::arg("fast_simplification") = false, py::arg("distance_func") = 0);
-    m.def("discrete_klmedian", &Clustering::kl_median, py::arg("k") = 2, py::arg("l") = 2, py::arg("curves"), py::arg("consecutive_call") = false, py::arg("fast_simplification") = false, py::arg("distance_func") = 0);
+    m.def("discrete_klcenter", [](const curve_number_t k, const curve_size_t l, const Curves &curves, const unsigned int local_search, const bool consecutive_call, const bool random_first_center, const bool fast_simplification, const unsigned int distance_func, const Config::Options *options) {
+        return Clustering::kl_center(k, l, curves, local_search, consecutive_call, random_first_center, fast_simplification, distance_func, call_options(options));
+    }, py::arg("k") = 2, py::arg("l") = 2, py::arg("curves"), py::arg("local_search") = 0, py::arg("consecutive_call") = false, py::arg("random_first_center") = true, py::arg("fast_simplification") = false, py::arg("distance_func") = 0, py::arg("options") = py::none());
+    m.def("discrete_klmedian", [](const curve_number_t k, const curve_size_t l, const Curves &curves, const bool consecutive_call, const bool fast_simplification, const unsigned int distance_func, const Config::Options *options) {
+        return Clustering::kl_median(k, l, curves, consecutive_call, fast_simplification, distance_func, call_options(options));
+    }, py::arg("k") = 2, py::arg("l") = 2, py::arg("curves"), py::arg("consecutive_call") = false, py::arg("fast_simplification") = false, py::arg("distance_func") = 0, py::arg("options") = py::none());
 
 }
@@ -33,7 +33,7 @@ Curves transform_naive(const Curves &in, const distance_t epsilon, const bool em
     std::cout << "populating " << new_number_dimensions << "x" << old_number_dimensions << " matrix" << std::endl;
     #endif
     
-    #pragma omp parallel for
+    // the generator is not thread-safe
     for (dimensions_t i = 0; i < new_number_dimensions; ++i) {
         mat[i] = rg.get(old_number_dimensions);
     }
@@ -46,17 +46,21 @@ Curves transform_naive(const Curves &in, const distance_t epsilon, const bool em
     for (curve_number_t l = 0; l < in.size(); ++l) result[l] = Curve(in[l].complexity(), new_number_dimensions, in[l].get_name());
     
     for (curve_number_t l = 0; l < in.size(); ++l) {
+        const Curve &curve = in[l];
+        // non-const access to the points may copy them, so it happens once before the loop
+        coordinate_t *coordinates = result[l].data();
+        
         #pragma omp parallel for collapse(2)
-        for (curve_size_t i = 0; i < in[l].complexity(); ++i) {
+        for (curve_size_t i = 0; i < curve.complexity(); ++i) {
             for (dimensions_t j = 0; j < new_number_dimensions; ++j) {
                 
-                result[l][i][j] = mat[j][0] * in[l][i][0];
+                coordinate_t value = mat[j][0] * curve[i][0];
                 
-                for (dimensions_t k = 1; k < in[l].dimensions(); ++k) {
-                    result[l][i][j] += mat[j][k] * in[l][i][k];
+                for (dimensions_t k = 1; k < curve.dimensions(); ++k) {
+                    value += mat[j][k] * curve[i][k];
                 }
                 
-                result[l][i][j] /= sqrtk;
+                coordinates[i * new_number_dimensions + j] = value / sqrtk;
                 
             }
         }
@@ -22,6 +22,21 @@ std::string Point::repr() const {
     return ss.str();
 }
 
+py::array_t<coordinate_t> Points::as_ndarray_view(const curve_size_t first, const curve_size_t count) const {
+    // the array keeps the buffer alive, it stays valid even if the points are modified or destroyed
+    const py::capsule base(new std::shared_ptr<const void>(buffer()), [](void *p) { delete reinterpret_cast<std::shared_ptr<const void>*>(p); });
+    py::array_t<coordinate_t> result({count, dim}, coordinates + first * dim, base);
+    result.attr("setflags")(py::arg("write") = false);
+    return result;
+}
+
+std::shared_ptr<const void> share_array(const py::array &array) {
+    return std::shared_ptr<const void>(new py::object(array), [](py::object *array) { 
+        py::gil_scoped_acquire acquire;
+        delete array; 
+    });
+}
+
 std::string Points::str() const {
     std::stringstream ss;
     ss << *this;
@@ -34,8 +49,8 @@ std::string Points::repr() const {
     return ss.str();
 }
 
-std::ostream& operator<<(std::ostream &out, const Point &p) {
-    if (p.empty()) return out;
+std::ostream& operator<<(std::ostream &out, const Const_Point_View &p) {
+    if (p.dimensions() == 0) return out;
     out << "(" << std::flush;
     
     for (dimensions_t i = 0; i < p.dimensions() - 1; ++i){
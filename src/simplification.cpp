@@ -16,35 +16,29 @@ namespace Continuous {
 
 namespace Simplification {
     
-Subcurve_Shortcut_Graph::Subcurve_Shortcut_Graph(const Curve &pcurve) : curve{const_cast<Curve&>(pcurve)}, 
+Subcurve_Shortcut_Graph::Subcurve_Shortcut_Graph(const Curve &curve, const Config::Options &options) : curve{curve}, options{options}, 
         edges{std::vector<std::vector<distance_t>>(curve.complexity(), std::vector<distance_t>(curve.complexity(), std::numeric_limits<distance_t>::infinity()))} {
             
-    if (Config::verbosity > 1) py::print("SIMPL: computing shortcut graph");
+    if (options.verbosity > 1) py::print("SIMPL: computing shortcut graph");
     const curve_size_t complexity = curve.complexity();
-    Curve segment(2, curve.front().dimensions());
-    Distance dist;
     
-    for (curve_size_t i = 0; i < complexity - 1; ++i) {
-        for (curve_size_t j = i + 1; j < complexity; ++j) {
-            
-            if (Config::verbosity > 1) py::print("SIMPL: computing shortcut distance from vertex ", i, " to vertex ", j);
-            
-            curve.set_subcurve(i, j);
-            
-            segment[0] = curve.front();
-            segment[1] = curve.back();
-            
-            dist = distance(curve, segment);
-            edges[i][j] = dist.value;
-            
-            curve.reset_subcurve();
-        }
+    // the shortcuts (i, j) are numbered row by row, chunks of consecutive shortcuts are handed out dynamically, as they take longer the larger j - i
+    const std::size_t rows = complexity - 1, shortcuts = rows * complexity / 2;
+    
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (std::size_t shortcut = 0; shortcut < shortcuts; ++shortcut) {
+        // row i starts at shortcut i * rows - i * (i - 1) / 2
+        curve_size_t i = std::max(0.l, std::floor(rows + .5l - std::sqrt((rows + .5l) * (rows + .5l) - 2.l * shortcut)));
+        while (i > 0 and i * rows - i * (i - 1) / 2 > shortcut) --i;
+        while ((i + 1) * rows - (i + 1) * i / 2 <= shortcut) ++i;
+        const curve_size_t j = shortcut - (i * rows - i * (i - 1) / 2) + i + 1;
         
+        edges[i][j] = segment_distance(curve.subcurve(i, j), curve[i], curve[j]);
     }
 }
 
 Curve Subcurve_Shortcut_Graph::minimum_error_simplification(const curve_size_t ll) const {
-    if (Config::verbosity > 1) py::print("SIMPL: computing exact minimum error simplification using shortcut graph");
+    if (options.verbosity > 1) py::print("SIMPL: computing exact minimum error simplification using shortcut graph");
     if (ll >= curve.complexity()) return curve;
     
     const curve_size_t l = ll - 1;
@@ -60,117 +54,112 @@ Curve Subcurve_Shortcut_Graph::minimum_error_simplification(const curve_size_t l
     std::vector<std::vector<distance_t>> distances(curve.complexity(), std::vector<distance_t>(l, std::numeric_limits<distance_t>::infinity()));
     std::vector<std::vector<curve_size_t>> predecessors(curve.complexity(), std::vector<curve_size_t>(l));
     
-    std::vector<distance_t> others;
-    curve_size_t best = 0;
     for (curve_size_t i = 0; i < l; ++i) {
         
         if (i == 0) {
-            if (Config::verbosity > 1) py::print("SIMPL: initializing arrays");
+            if (options.verbosity > 1) py::print("SIMPL: initializing arrays");
             #pragma omp parallel for
             for (curve_size_t j = 1; j < curve.complexity(); ++j) {
                 distances[j][0] = edges[0][j];
                 predecessors[j][0] = 0;
             }
         } else {
+            if (options.verbosity > 1) py::print("SIMPL: computing shortcuts using ", i, " jumps");
+            // every vertex only depends on the last number of jumps
+            #pragma omp parallel for schedule(dynamic, 16)
             for (curve_size_t j = 1; j < curve.complexity(); ++j) {
-                if (Config::verbosity > 1) py::print("SIMPL: computing shortcut using ", i, " jumps");
-                others.resize(j);
-                #pragma omp parallel for
+                distance_t best_distance = std::numeric_limits<distance_t>::infinity();
+                curve_size_t best = 0;
+                
                 for (curve_size_t k = 0; k < j; ++k) {
-                    others[k] = std::max(distances[k][i - 1], edges[k][j]);
+                    const distance_t other = std::max(distances[k][i - 1], edges[k][j]);
+                    if (other < best_distance) {
+                        best_distance = other;
+                        best = k;
+                    }
                 }
                 
-                best = std::distance(others.begin(), std::min_element(others.begin(), others.end()));
-                
-                distances[j][i] = others[best];
+                distances[j][i] = best_distance;
                 predecessors[j][i] = best;
             }
         }
     }
     
-    if (Config::verbosity > 1) py::print("SIMPL: backwards constructing simplification");
+    if (options.verbosity > 1) py::print("SIMPL: backwards constructing simplification");
     
     curve_size_t ell = l - 1;
     
-    result.push_back(curve.back());
+    std::vector<curve_size_t> vertices(l + 1);
+    vertices[l] = curve.complexity() - 1;
     curve_size_t predecessor = predecessors[curve.complexity() - 1][ell];
     
-    for (curve_size_t i = 0; i < l - 1; ++i) {
-        result.push_back(curve[predecessor]);
+    for (curve_size_t i = l - 1; i > 0; --i) {
+        vertices[i] = predecessor;
         predecessor = predecessors[predecessor][--ell];
     }
     
-    result.push_back(curve.front());
-
-    std::reverse(result.begin(), result.end());
+    vertices[0] = 0;
+    
+    for (const curve_size_t vertex : vertices) {
+        result.push_back(curve[vertex]);
+    }
+    
     return result;
 }
  
-Curve approximate_minimum_link_simplification(const Curve &pcurve, const distance_t epsilon) {
-    if (Config::verbosity > 1) py::print("ASIMPL: computing approximate minimum link simplification for curve of complexity ", pcurve.complexity());
-    Curve &curve = const_cast<Curve&>(pcurve);
+Curve approximate_minimum_link_simplification(const Curve &curve, const distance_t epsilon, const Config::Options &options) {
+    if (options.verbosity > 1) py::print("ASIMPL: computing approximate minimum link simplification for curve of complexity ", curve.complexity());
     const curve_size_t complexity = curve.complexity();
     
     curve_size_t i = 0, j = 0, low, mid, high;
     
-    Curve simplification(curve.dimensions()), segment(2, curve.dimensions());
+    Curve simplification(curve.dimensions());
     simplification.push_back(curve.front());
     
     distance_t dist = 0;
     
     while (i < complexity - 1) {
         
-        segment[0] = curve[i];
         j = 0;
         dist = 0;
         
-        if (Config::verbosity > 1) py::print("ASIMPL: computing maximum length shortcut starting at ", i);
+        if (options.verbosity > 1) py::print("ASIMPL: computing maximum length shortcut starting at ", i);
         
-        if (Config::verbosity > 1) py::print("ASIMPL: exponential error search");
+        if (options.verbosity > 1) py::print("ASIMPL: exponential error search");
         
         while (dist <= epsilon) {
             ++j;
             
             if (i + std::pow(2, j) >= complexity) break;
             
-            curve.reset_subcurve();
-            segment[1] = curve[i + std::pow(2, j)];
-            curve.set_subcurve(i, i + std::pow(2, j));
-            
-            dist = distance(curve, segment).value;
+            dist = segment_distance(curve.subcurve(i, i + std::pow(2, j)), curve[i], curve[i + std::pow(2, j)]);
         }
         
         low = std::pow(2, j - 1);
         high = std::min(static_cast<curve_size_t>(std::pow(2, j)), complexity - i - 1);
         
-        if (Config::verbosity > 1) py::print("ASIMPL: binary error search for low = ", low, " and high = ", high);
+        if (options.verbosity > 1) py::print("ASIMPL: binary error search for low = ", low, " and high = ", high);
         
         while (low < high) {
             mid = std::ceil(low + (high - low) * .5);
-                        
-            curve.reset_subcurve();
-            segment[1] = curve[i + mid];
-            curve.set_subcurve(i, i + mid);
             
-            dist = distance(curve, segment).value;
+            dist = segment_distance(curve.subcurve(i, i + mid), curve[i], curve[i + mid]);
                                     
             if (dist > epsilon) high = mid - 1;
             else low = mid;
         }
         
-        if (Config::verbosity > 1) py::print("ASIMPL: shortcutting from ", i, " to ", i+low);
+        if (options.verbosity > 1) py::print("ASIMPL: shortcutting from ", i, " to ", i+low);
         
         i += low;
         
-        curve.reset_subcurve();
-        
         simplification.push_back(curve[i]);
     }
     return simplification;
 }
 
-Curve approximate_minimum_error_simplification(const Curve &curve, const curve_size_t ell) {
-    if (Config::verbosity > 1) py::print("ASIMPL: computing approximate minimum error simplification");
+Curve approximate_minimum_error_simplification(const Curve &curve, const curve_size_t ell, const Config::Options &options) {
+    if (options.verbosity > 1) py::print("ASIMPL: computing approximate minimum error simplification");
     if (ell >= curve.complexity()) return curve;
     Curve simplification(curve.dimensions()), segment(2, curve.dimensions());
     
@@ -179,22 +168,22 @@ Curve approximate_minimum_error_simplification(const Curve &curve, const curve_s
     
     if (ell <= 2) return segment;
     
-    distance_t min_distance = 0, max_distance = Frechet::Discrete::distance(curve, segment).value + 1, mid_distance;
+    distance_t min_distance = 0, max_distance = segment_distance(curve, curve.front(), curve.back()) + 1, mid_distance;
     
-    Curve new_simplification = approximate_minimum_link_simplification(curve, max_distance);
+    Curve new_simplification = approximate_minimum_link_simplification(curve, max_distance, options);
 
-    if (Config::verbosity > 1) py::print("ASIMPL: computing upper bound for error by exponential search");
+    if (options.verbosity > 1) py::print("ASIMPL: computing upper bound for error by exponential search");
     while (new_simplification.complexity() > ell) {
         max_distance *= 2.;
-        new_simplification = approximate_minimum_link_simplification(curve, max_distance);
+        new_simplification = approximate_minimum_link_simplification(curve, max_distance, options);
     }
     
-    if (Config::verbosity > 1) py::print("ASIMPL: binary search using upper bound");
-    const distance_t epsilon = std::max(min_distance * Frechet::Continuous::error / 100, std::numeric_limits<distance_t>::epsilon());
+    if (options.verbosity > 1) py::print("ASIMPL: binary search using upper bound");
+    const distance_t epsilon = std::max(min_distance * options.continuous_frechet_error / 100, std::numeric_limits<distance_t>::epsilon());
     while (max_distance - min_distance > epsilon) {
         mid_distance = (min_distance + max_distance) / distance_t(2);
         if (mid_distance == max_distance or mid_distance == min_distance) break;
-        new_simplification = approximate_minimum_link_simplification(curve, mid_distance);
+        new_simplification = approximate_minimum_link_simplification(curve, mid_distance, options);
         
         if (new_simplification.complexity() > ell) min_distance = mid_distance;
         else {
@@ -202,7 +191,7 @@ Curve approximate_minimum_error_simplification(const Curve &curve, const curve_s
             max_distance = mid_distance;
         }
     }
-    if (Config::verbosity > 1) py::print("ASIMPL: backwards construction of simplification");
+    if (options.verbosity > 1) py::print("ASIMPL: backwards construction of simplification");
     curve_size_t diff = ell - simplification.complexity();
     while (diff > 0) {
         simplification.push_back(simplification.back());
@@ -223,82 +212,71 @@ namespace Discrete {
     
 namespace Simplification {
     
-Curve approximate_minimum_error_simplification(const Curve &curve, const curve_size_t ell) {
-
-    const auto dist_f = [&](const curve_size_t i, const curve_size_t j, const Point &x) {
-        distance_t result = 0;
-                        
-        for (curve_size_t k = i; k <= j; ++k) {
-            result += curve[k].dist(x);
-        }
-        
-        return result;
-    };
-    
+Curve approximate_minimum_error_simplification(const Curve &curve, const curve_size_t ll) {
     const auto infty = std::numeric_limits<distance_t>::infinity();
-    const curve_size_t n = curve.size(), m = n - 1;
-    
-    if (ell >= m) return curve;
+    // a simplification has at least one vertex
+    const curve_size_t n = curve.size(), m = n - 1, ell = std::max(ll, curve_size_t(1));
     
-    std::vector<std::vector<distance_t>> d(n, std::vector<distance_t>(ell, infty));
-    std::vector<std::vector<Points>> c(n, std::vector<Points>(ell, Points(curve.dimensions())));
+    if (n <= ell + 1) return curve;
     
-    distance_t tdist, mindist;
-    curve_size_t minpoint, mip;
+    // prefix[t][k] is the cost of matching vertices 0, ..., t - 1 to vertex k, so vertices a, ..., b cost prefix[b + 1][k] - prefix[a][k]
+    std::vector<std::vector<distance_t>> prefix(n + 1, std::vector<distance_t>(n, 0));
+    #pragma omp parallel for
+    for (curve_size_t k = 0; k < n; ++k) {
+        for (curve_size_t t = 0; t < n; ++t) {
+            prefix[t + 1][k] = prefix[t][k] + curve[t].dist(curve[k]);
+        }
+    }
     
-    // every prefix 0...i
-    for (curve_size_t i = 0; i < curve.size(); ++i) {
-        
-        mindist = infty;
-        
-        // point that best summarizes prefix
-        for (curve_size_t k = 0; k < curve.size(); ++k) {
-            tdist = dist_f(0, i, curve[k]);
+    // d[i][j] is the cost of the prefix 0, ..., i summarized by j + 1 vertices, of which the last is point[i][j]
+    // and summarizes the vertices after predecessor[i][j]
+    std::vector<std::vector<distance_t>> d(n, std::vector<distance_t>(ell, infty));
+    std::vector<std::vector<curve_size_t>> predecessor(n, std::vector<curve_size_t>(ell, 0)), point(n, std::vector<curve_size_t>(ell, 0));
+    
+    // the infixes a, ..., b are taken by increasing start, so the prefix up to a - 1 is final when they are
+    for (curve_size_t a = 0; a < n; ++a) {
+        #pragma omp parallel for
+        for (curve_size_t b = a; b < n; ++b) {
+            // vertex that best summarizes the infix
+            distance_t cost = infty;
+            curve_size_t best = 0;
+            for (curve_size_t k = 0; k < n; ++k) {
+                const distance_t tcost = prefix[b + 1][k] - prefix[a][k];
+                if (tcost < cost) {
+                    cost = tcost;
+                    best = k;
+                }
+            }
             
-            if (tdist < mindist) {
-                mindist = tdist;
-                minpoint = k;
+            if (a == 0) {
+                d[b][0] = cost;
+                point[b][0] = best;
+                continue;
             }
-        }
-    
-        c[i][0].push_back(curve[minpoint]);
-        d[i][0] = mindist;
-    }
-        
-    // for every infix
-    for (curve_size_t i = 1; i < curve.size(); ++i) {
-        
-        // for every remaining simplification point
-        for (curve_size_t j = 1; j < ell; ++j) {
             
-        mindist = infty;
-        
-            // check for best prefix
-            for (curve_size_t ip = 0; ip < i; ++ip) {
-                
-                // point that best summarizes prefix + infix
-                for (curve_size_t k = 0; k < curve.size(); ++k) {
-                    tdist = d[ip][j - 1] + dist_f(ip + 1, i, curve[k]);
-                    
-                    if (tdist < mindist) {
-                        mindist = tdist;
-                        minpoint = k;
-                        mip = ip;
-                    }
+            for (curve_size_t j = 1; j < ell; ++j) {
+                const distance_t tdist = d[a - 1][j - 1] + cost;
+                if (tdist < d[b][j]) {
+                    d[b][j] = tdist;
+                    predecessor[b][j] = a - 1;
+                    point[b][j] = best;
                 }
-                
             }
-            
-            c[i][j] = c[mip][j - 1];
-            c[i][j].push_back(curve[minpoint]);
-            d[i][j] = mindist;
-                
         }
     }
     
-    const curve_size_t min_ell = std::distance(d[m].begin(), std::min_element(d[m].begin(), d[m].end()));
-    return Curve(c[m][min_ell]);
+    curve_size_t j = std::distance(d[m].begin(), std::min_element(d[m].begin(), d[m].end()));
+    std::vector<curve_size_t> vertices(j + 1);
+    for (curve_size_t i = m; ; i = predecessor[i][j--]) {
+        vertices[j] = point[i][j];
+        if (j == 0) break;
+    }
     
+    Curve result(curve.dimensions());
+    for (const curve_size_t vertex : vertices) {
+        result.push_back(curve[vertex]);
+    }
+    return result;
 }
 
 }
@@ -2,6 +2,82 @@ import numpy as np
 import unittest
 import Fred.backend as fred
 
+class TestCurve(unittest.TestCase):
+    
+    def test_values(self):
+        a = np.array([[0.0, 1.0], [2.0, 3.0], [4.0, 5.0]])
+        b = fred.Curve(a)
+        c = fred.Curve(a, "c", copy=False)
+        self.assertTrue(np.array_equal(b.values, a))
+        self.assertFalse(np.shares_memory(b.values, a))
+        self.assertTrue(np.shares_memory(c.values, a))
+        self.assertFalse(c.values.flags.writeable)
+
+class TestCurves(unittest.TestCase):
+    
+    def test_ragged(self):
+        values = np.arange(12, dtype=float).reshape(6, 2)
+        curves = fred.Curves(values, np.array([0, 2, 6]))
+        self.assertEqual(len(curves), 2)
+        self.assertEqual(curves.m, 4)
+        self.assertTrue(np.array_equal(curves[0].values, values[:2]))
+        self.assertTrue(np.array_equal(curves[1].values, values[2:]))
+        
+    def test_equal_complexity(self):
+        values = np.arange(24, dtype=float).reshape(3, 4, 2)
+        curves = fred.Curves(values, copy=False)
+        self.assertEqual(len(curves), 3)
+        self.assertTrue(np.array_equal(curves.values, values))
+        
+    def test_save_load(self):
+        import os, tempfile
+        values = np.random.rand(10, 2)
+        curves = fred.Curves(values, np.array([0, 3, 3, 10]))
+        path = os.path.join(tempfile.mkdtemp(), "curves.fred")
+        curves.save(path)
+        loaded = fred.Curves.load(path)
+        self.assertEqual(len(loaded), 3)
+        self.assertEqual(loaded[2].name, curves[2].name)
+        self.assertTrue(np.array_equal(loaded[2].values, values[3:]))
+        self.assertEqual(fred.continuous_frechet(loaded[0], loaded[2]).value, fred.continuous_frechet(curves[0], curves[2]).value)
+        
+    def test_load_invalid(self):
+        import os, tempfile
+        curves = fred.Curves(np.random.rand(10, 2), np.array([0, 3, 10]))
+        path = os.path.join(tempfile.mkdtemp(), "curves.fred")
+        curves.save(path)
+        with open(path, "rb") as file:
+            data = file.read()
+        # header of 48 bytes, 3 offsets, 10 points, names
+        names = 48 + 3 * 8 + 10 * 2 * 8
+        first_offset, last_offset = bytearray(data), bytearray(data)
+        first_offset[48:56] = (1).to_bytes(8, "little")
+        last_offset[64:72] = (9).to_bytes(8, "little")
+        missing_name = bytearray(data)
+        missing_name[names + data[names:].index(0)] = ord("x")
+        for corrupt in (first_offset, last_offset, missing_name):
+            with open(path, "wb") as file:
+                file.write(corrupt)
+            with self.assertRaises(RuntimeError):
+                fred.Curves.load(path)
+        
+    def test_simplify(self):
+        curves = fred.Curves(np.random.rand(20, 10, 2))
+        calls = []
+        simplified = curves.simplify(4, progress=lambda done, total: calls.append((done, total)))
+        self.assertEqual(len(simplified), 20)
+        self.assertTrue(np.array_equal(simplified[7].values, fred.frechet_minimum_error_simplification(curves[7], 4).values))
+        self.assertEqual(calls[-1], (20, 20))
+        self.assertTrue(all(total == 20 for _, total in calls))
+        self.assertEqual(calls, sorted(calls))
+        
+    def test_simplify_progress_error(self):
+        curves = fred.Curves(np.random.rand(20, 10, 2))
+        def progress(done, total):
+            raise ValueError("stop")
+        with self.assertRaises(ValueError):
+            curves.simplify(4, progress=progress)
+
 class TestContinuousFrechet(unittest.TestCase):
 
     def test_zigzag1d(self):
@@ -10,11 +86,67 @@ class TestContinuousFrechet(unittest.TestCase):
         c = fred.Curve([0.0, 1.0])
         self.assertEqual(round(fred.continuous_frechet(a, b).value, 2), 0.25)
         self.assertEqual(round(fred.continuous_frechet(a, c).value, 1), 0.5)
+        self.assertAlmostEqual(fred.continuous_frechet(a, b, exact=True).value, 0.25)
+        self.assertAlmostEqual(fred.continuous_frechet(a, c, exact=True).value, 0.5)
+        
+    def test_options(self):
+        a = fred.Curve([[0.0, 0.0], [1.0, 2.0], [2.0, -1.0], [3.0, 1.0], [4.0, 0.0]])
+        b = fred.Curve([[0.0, 0.5], [1.5, -1.0], [2.5, 2.0], [4.0, 0.5]])
+        options = fred.Options()
+        options.continuous_frechet_error = 50
+        coarse = fred.continuous_frechet(a, b, options=options)
+        self.assertEqual(fred.config.continuous_frechet_error, 1)
+        self.assertLessEqual(coarse.number_searches, fred.continuous_frechet(a, b).number_searches)
+        
+    def test_budget(self):
+        a = fred.Curve([[0.0, 0.0], [1.0, 2.0], [2.0, -1.0], [3.0, 1.0], [4.0, 0.0]])
+        b = fred.Curve([[0.0, 0.5], [1.5, -1.0], [2.5, 2.0], [4.0, 0.5]])
+        full = fred.continuous_frechet(a, b)
+        for exact in (False, True):
+            dist = fred.continuous_frechet(a, b, exact=exact, max_searches=1)
+            self.assertLessEqual(dist.number_searches, 1)
+            self.assertEqual(dist.value, dist.upper_bound)
+            self.assertLessEqual(dist.lower_bound, full.value)
+            self.assertGreaterEqual(dist.upper_bound, full.lower_bound)
         
     def test_longsegment(self):
         a = fred.Curve([0.0,500.0e3, 1.0e6])
         b = fred.Curve([0.0, 1.0e6])
         self.assertEqual(round(fred.continuous_frechet(a, b).value, 3), 0.0)
+        
+    def test_dimensions(self):
+        # zero coordinates do not change the distance, whether the kernel is specialized for the number of dimensions or not
+        for _ in range(10):
+            a, b = np.random.rand(12, 2), np.random.rand(9, 2)
+            expected = fred.continuous_frechet(fred.Curve(a), fred.Curve(b), exact=True).value
+            for d in (3, 5):
+                padded_a, padded_b = np.zeros((12, d)), np.zeros((9, d))
+                padded_a[:, :2], padded_b[:, :2] = a, b
+                self.assertAlmostEqual(fred.continuous_frechet(fred.Curve(padded_a), fred.Curve(padded_b), exact=True).value, expected)
+        
+    def test_compact(self):
+        options = fred.Options()
+        options.continuous_frechet_compact = True
+        for _ in range(20):
+            a, b = fred.Curve(np.random.rand(15, 2)), fred.Curve(np.random.rand(10, 2))
+            distance = fred.continuous_frechet(a, b, exact=True).value
+            self.assertAlmostEqual(fred.continuous_frechet(a, b, exact=True, options=options).value, distance)
+            self.assertTrue(fred.frechet_less_than(a, b, distance * (1 + 1e-6), options=options))
+            self.assertFalse(fred.frechet_less_than(a, b, distance * (1 - 1e-6), options=options))
+        
+    def test_exact_small(self):
+        a = fred.Curve([0.0, 1.0, 1.0 - 1e-6, 2.0])
+        b = fred.Curve([0.0, 0.5, 2.0])
+        c = fred.Curve([0.0, 0.5, 1.0, 2.0])
+        self.assertAlmostEqual(fred.continuous_frechet(a, b, exact=True).value, 5e-7, delta=1e-12)
+        self.assertAlmostEqual(fred.continuous_frechet(c, b, exact=True).value, 0.0, delta=1e-12)
+        
+    def test_exact_monotonicity(self):
+        # in 1D every vertex lies on the segment, the distance is half of the largest step back, a monotonicity event
+        x = np.random.rand(200)
+        x[0], x[-1] = 0.0, 1.0
+        expected = np.max(np.maximum.accumulate(x) - x) / 2
+        self.assertAlmostEqual(fred.continuous_frechet(fred.Curve(x), fred.Curve([0.0, 1.0]), exact=True).value, expected)
 
 class TestDiscreteFrechet(unittest.TestCase):
     
@@ -24,12 +156,28 @@ class TestDiscreteFrechet(unittest.TestCase):
         c = fred.Curve([0.0, 1.0])
         self.assertEqual(fred.discrete_frechet(a, b).value, 0.25)
         self.assertEqual(fred.discrete_frechet(a, c).value, 1.0)
+        self.assertEqual(fred.discrete_frechet(a, c, cutoff=1.0).value, 1.0)
+        self.assertEqual(fred.discrete_frechet(a, c, cutoff=0.5).value, np.inf)
         
     def test_longsegment(self):
         a = fred.Curve([0.0,500.0e3, 1.0e6])
         b = fred.Curve([0.0, 1.0e6])
         self.assertEqual(fred.discrete_frechet(a, b).value, 500000.0)
         
+    def test_long(self):
+        x = np.linspace(0.0, 1.0, 5000)
+        a = fred.Curve(np.column_stack((x, np.zeros(5000))))
+        b = fred.Curve(np.column_stack((x, np.ones(5000))))
+        self.assertEqual(fred.discrete_frechet(a, b).value, 1.0)
+        
+    def test_long_cutoff(self):
+        # the diagonal coupling skips every second anti-diagonal, whose cells are all at distance 100
+        x = np.tile([0.0, 100.0], 2500)
+        a, b = fred.Curve(x), fred.Curve(x + 1.0)
+        self.assertEqual(fred.discrete_frechet(a, a, 50.0).value, 0.0)
+        self.assertEqual(fred.discrete_frechet(a, b, 1.5).value, 1.0)
+        self.assertEqual(fred.discrete_frechet(a, b, 0.5).value, float("inf"))
+        
 class TestDiscreteDynamicTimeWarping(unittest.TestCase):
     
     def test_zigzag1d(self):
@@ -38,11 +186,174 @@ class TestDiscreteDynamicTimeWarping(unittest.TestCase):
         c = fred.Curve([0.0, 1.0])
         self.assertEqual(fred.discrete_dynamic_time_warping(a, b).value, 0.5)
         self.assertEqual(fred.discrete_dynamic_time_warping(a, c).value, 1.0)
+        self.assertEqual(fred.discrete_dynamic_time_warping(a, b, cutoff=0.25).value, np.inf)
         
     def test_longsegment(self):
         a = fred.Curve([0.0,500.0e3, 1.0e6])
         b = fred.Curve([0.0, 1.0e6])
         self.assertEqual(fred.discrete_dynamic_time_warping(a, b).value, 500000.0)
+        
+    def test_band(self):
+        a = fred.Curve([0.0, 0.0, 1.0])
+        b = fred.Curve([0.0, 1.0, 1.0])
+        self.assertEqual(fred.discrete_dynamic_time_warping(a, b).value, 0.0)
+        options = fred.Options()
+        options.dtw_sakoe_chiba_radius = 0
+        self.assertEqual(fred.discrete_dynamic_time_warping(a, b, options=options).value, 1.0)
+        options.dtw_sakoe_chiba_radius = 1
+        self.assertEqual(fred.discrete_dynamic_time_warping(a, b, options=options).value, 0.0)
+        
+    def test_value_only(self):
+        # the functions only compute the value, rows run along the shorter curve; the clustering keeps the warping paths
+        curves = fred.Curves(np.random.rand(8, 12, 2))
+        short = fred.Curve(np.random.rand(5, 2))
+        for curve in curves:
+            self.assertAlmostEqual(fred.discrete_dynamic_time_warping(curve, short).value, fred.discrete_dynamic_time_warping(short, curve).value)
+        result = fred.discrete_klcenter(2, 5, curves, distance_func=2)
+        result.compute_assignment(curves, consecutive_call=True)
+        for i in range(len(result)):
+            for j in range(result.assignment.count(i)):
+                expected = fred.discrete_dynamic_time_warping(curves[result.assignment.get(i, j)], result[i]).value
+                self.assertAlmostEqual(result.assignment.distance(i, j), expected)
+        
+    def test_approximation(self):
+        # the approximation follows a warping path, it never undercuts the exact distance and is exact once the radius covers the curves
+        a = fred.Curve(np.random.rand(200, 2))
+        b = fred.Curve(np.random.rand(150, 2))
+        exact = fred.discrete_dynamic_time_warping(a, b).value
+        options = fred.Options()
+        for radius in [0, 1, 2]:
+            options.dtw_approximation_radius = radius
+            self.assertGreaterEqual(fred.discrete_dynamic_time_warping(a, b, options=options).value, exact - 1e-9)
+        options.dtw_approximation_radius = 1000
+        self.assertAlmostEqual(fred.discrete_dynamic_time_warping(a, b, options=options).value, exact)
+        self.assertEqual(fred.config.dtw_approximation_radius, -1)
+        # with a band, the approximation stays within it
+        banded = fred.Options()
+        banded.dtw_itakura_slope = 1.5
+        for _ in range(200):
+            a, b = fred.Curve(np.random.rand(np.random.randint(2, 40), 2)), fred.Curve(np.random.rand(np.random.randint(2, 40), 2))
+            exact = fred.discrete_dynamic_time_warping(a, b, options=banded).value
+            banded.dtw_approximation_radius = 0
+            self.assertGreaterEqual(fred.discrete_dynamic_time_warping(a, b, options=banded).value, exact - 1e-9)
+            banded.dtw_approximation_radius = -1
+
+class TestDistances(unittest.TestCase):
+    
+    def test_pairwise(self):
+        curves = fred.Curves(np.random.rand(5, 4, 2))
+        matrix = fred.pairwise_distances(curves, distance_func=1)
+        self.assertEqual(matrix.shape, (5, 5))
+        self.assertTrue(np.array_equal(matrix, matrix.T))
+        self.assertTrue(np.array_equal(matrix, fred.pairwise_distances(curves, curves, distance_func=1)))
+        self.assertTrue(np.array_equal(matrix[2], fred.distances(curves[2], curves, distance_func=1)))
+        self.assertEqual(matrix[0, 3], fred.discrete_frechet(curves[0], curves[3]).value)
+        
+    def test_less_than(self):
+        a = fred.Curve([0.0, 1.0, 0.0, 1.0])
+        b = fred.Curve([0.0, 0.75, 0.25, 1.0])
+        self.assertTrue(fred.frechet_less_than(a, b, 0.3))
+        self.assertFalse(fred.frechet_less_than(a, b, 0.2))
+        self.assertFalse(fred.frechet_less_than(a, b, 0.2, discrete=True))
+        curves = fred.Curves()
+        curves.add(b)
+        curves.add(a)
+        self.assertTrue(np.array_equal(fred.frechet_less_than(a, curves, 0.3), [True, True]))
+        
+    def test_less_than_random(self):
+        # the decision has to agree with the distance found by the search over critical values, and with the discrete distance as an upper bound
+        for _ in range(20):
+            a, b = fred.Curve(np.random.rand(15, 2)), fred.Curve(np.random.rand(10, 2))
+            distance = fred.continuous_frechet(a, b, exact=True).value
+            self.assertTrue(fred.frechet_less_than(a, b, distance * (1 + 1e-6)))
+            self.assertFalse(fred.frechet_less_than(a, b, distance * (1 - 1e-6)))
+            self.assertTrue(fred.frechet_less_than(a, b, fred.discrete_frechet(a, b).value))
+
+class TestClustering(unittest.TestCase):
+    
+    def test_dtw_lower_bounds(self):
+        # the lower bounds only skip centers that are not nearest, so the cost equals the one of all distances
+        options = fred.Options()
+        for radius in (-1, 2):
+            options.dtw_sakoe_chiba_radius = radius
+            for m in (8, 12):
+                curves = fred.Curves(np.random.rand(10, m, 2))
+                result = fred.discrete_klmedian(3, 4, curves, distance_func=2, options=options)
+                expected = sum(min(fred.discrete_dynamic_time_warping(curve, center, options=options).value for center in result) for curve in curves)
+                self.assertAlmostEqual(result.value, expected)
+        
+    def test_consecutive_call(self):
+        # every clustering keeps its own distances, a clustering of other curves in between does not change them
+        curves = fred.Curves(np.random.rand(10, 8, 2))
+        result = fred.discrete_klcenter(3, 4, curves, distance_func=1)
+        fred.discrete_klcenter(2, 4, fred.Curves(np.random.rand(6, 5, 2)), distance_func=1)
+        for consecutive_call in (True, False):
+            result.compute_assignment(curves, consecutive_call=consecutive_call)
+            for i in range(len(result)):
+                for j in range(result.assignment.count(i)):
+                    expected = fred.discrete_frechet(result[i], curves[result.assignment.get(i, j)]).value
+                    self.assertAlmostEqual(result.assignment.distance(i, j), expected)
+        
+    def test_consecutive_call_other_input(self):
+        # a consecutive call continues with the cache of its own input, not with the last one of the same size
+        curves, others = fred.Curves(np.random.rand(10, 8, 2)), fred.Curves(np.random.rand(10, 8, 2))
+        first = fred.discrete_klcenter(3, 4, curves, distance_func=1)
+        fred.discrete_klcenter(3, 4, others, distance_func=1)
+        for result, assigned in ((fred.discrete_klcenter(2, 4, curves, consecutive_call=True, distance_func=1), curves), (first, others)):
+            result.compute_assignment(assigned, consecutive_call=True)
+            for i in range(len(result)):
+                for j in range(result.assignment.count(i)):
+                    expected = fred.discrete_frechet(result[i], assigned[result.assignment.get(i, j)]).value
+                    self.assertAlmostEqual(result.assignment.distance(i, j), expected)
+
+class TestSimplification(unittest.TestCase):
+    
+    # the second vertex lies ahead of the third along the shortcut, so the distance is raised above the vertices' distances to it
+    zigzag = np.array([[0.0, 0.0], [2.0, 0.1], [1.0, -0.1], [3.0, 0.0], [4.0, 1.0], [3.5, 1.2], [5.0, 1.0], [6.0, 0.0]])
+    
+    def errors(self, values, indices):
+        return [fred.continuous_frechet(fred.Curve(values[i:j+1]), fred.Curve(values[[i, j]]), exact=True).value for i, j in zip(indices, indices[1:])]
+        
+    def indices(self, values, simplification):
+        result, i = [], 0
+        for vertex in simplification.values:
+            while not np.array_equal(values[i], vertex):
+                i += 1
+            result.append(i)
+        return result
+    
+    def test_minimum_error(self):
+        import itertools
+        for values in (self.zigzag, np.random.rand(8, 2)):
+            simplification = fred.frechet_minimum_error_simplification(fred.Curve(values), 4)
+            self.assertEqual(len(simplification), 4)
+            error = max(self.errors(values, self.indices(values, simplification)))
+            best = min(max(self.errors(values, (0,) + inner + (7,))) for inner in itertools.combinations(range(1, 7), 2))
+            self.assertAlmostEqual(error, best, delta=1e-6)
+        
+    def test_approximate_minimum_link(self):
+        self.assertAlmostEqual(self.errors(self.zigzag, [0, 3])[0], np.sqrt(0.26))
+        for values in (self.zigzag, np.random.rand(20, 2)):
+            for epsilon in (0.3, 0.6):
+                simplification = fred.frechet_approximate_minimum_link_simplification(fred.Curve(values), epsilon)
+                self.assertLessEqual(max(self.errors(values, self.indices(values, simplification))), epsilon + 1e-6)
+        self.assertGreater(len(fred.frechet_approximate_minimum_link_simplification(fred.Curve(self.zigzag[:4]), 0.3)), 2)
+        
+    def test_dtw_minimum_error(self):
+        import itertools
+        values = np.random.rand(6, 2)
+        distances = np.linalg.norm(values[:, None] - values[None, :], axis=2)
+        # every group of consecutive vertices is summarized by one vertex of the curve
+        def partitions(j):
+            for cuts in itertools.combinations(range(1, 6), j - 1):
+                yield zip((0,) + cuts, cuts + (6,))
+        for ell in (1, 2, 3):
+            best = min(sum(distances[a:b].sum(axis=0).min() for a, b in groups) for j in range(1, ell + 1) for groups in partitions(j))
+            simplification = fred.dtw_approximate_minimum_error_simplification(fred.Curve(values), ell).values
+            self.assertLessEqual(len(simplification), ell)
+            cost = min(sum(np.linalg.norm(values[a:b] - vertex, axis=1).sum() for (a, b), vertex in zip(groups, simplification)) for groups in partitions(len(simplification)))
+            self.assertAlmostEqual(cost, best)
+        self.assertEqual(len(fred.dtw_approximate_minimum_error_simplification(fred.Curve(values), 0)), 1)
 
 if __name__ == '__main__':
     unittest.main()